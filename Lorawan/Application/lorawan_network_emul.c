@@ -0,0 +1,175 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Minimal LoRaWAN network stand-in for the emulated radio.
+*
+* @details  Answers the join requests sent through the emulated SX1262 with a
+*           join accept built from the keys in lorawan_key_config.h, and logs
+*           the uplinks. Confirmed uplinks are not acknowledged.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/byteorder.h>
+#include <tinycrypt/aes.h>
+#include <tinycrypt/cmac_mode.h>
+#include <tinycrypt/constants.h>
+
+#include "smtc_modem_api.h"
+#include "lorawan_key_config.h"
+#include "sx126x_emul.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(NetworkEmul, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define MHDR_TYPE_MASK              0xE0
+#define MHDR_JOIN_REQUEST           0x00
+#define MHDR_JOIN_ACCEPT            0x20
+#define MHDR_UNCONFIRMED_UP         0x40
+#define MHDR_CONFIRMED_UP           0x80
+
+#define JOIN_REQUEST_SIZE           23
+#define JOIN_REQUEST_DEVNONCE       17
+#define JOIN_ACCEPT_SIZE            17
+#define JOIN_ACCEPT_MIC             13
+#define UPLINK_MIN_SIZE             12
+
+#define NETWORK_NET_ID              0x000000
+#define NETWORK_DEV_ADDR            0x26000001
+#define NETWORK_RX_DELAY_S          1
+
+// DLSettings of the join accept, with the default RX2 data rate of the region.
+#define NETWORK_DL_SETTINGS         (((LORAWAN_REGION == SMTC_MODEM_REGION_US_915) ||      \
+                                      (LORAWAN_REGION == SMTC_MODEM_REGION_AU_915)) ? 0x08 : 0x00)
+
+#define DOWNLINK_RSSI               -60
+#define DOWNLINK_SNR                8
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static const uint8_t appKey[LORAWAN_APP_KEY_LEN] = LORAWAN_APP_KEY;
+
+static struct k_work joinAcceptWork;
+static uint16_t      joinDevNonce;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Build the join accept and queue it for the RX1 window.
+ *
+ * @param [in] work Work object.
+ */
+static void NetworkEmulJoinAccept(struct k_work *work)
+{
+   struct tc_aes_key_sched_struct sched;
+   struct tc_cmac_struct cmac;
+   uint8_t message[JOIN_ACCEPT_SIZE];
+   uint8_t mic[TC_AES_BLOCK_SIZE];
+
+   message[0] = MHDR_JOIN_ACCEPT;
+   // The JoinNonce must increase from one join to the next, as the DevNonce.
+   sys_put_le24(joinDevNonce + 1, &message[1]);
+   sys_put_le24(NETWORK_NET_ID, &message[4]);
+   sys_put_le32(NETWORK_DEV_ADDR, &message[7]);
+   message[11] = NETWORK_DL_SETTINGS;
+   message[12] = NETWORK_RX_DELAY_S;
+
+   tc_cmac_setup(&cmac, appKey, &sched);
+   tc_cmac_init(&cmac);
+   tc_cmac_update(&cmac, message, JOIN_ACCEPT_MIC);
+   tc_cmac_final(mic, &cmac);
+   memcpy(&message[JOIN_ACCEPT_MIC], mic, JOIN_ACCEPT_SIZE - JOIN_ACCEPT_MIC);
+
+   // The network decrypts, so the device encrypts to read the join accept.
+   tc_aes128_set_decrypt_key(&sched, appKey);
+   tc_aes_decrypt(&message[1], &message[1], &sched);
+
+   if (sx126x_emul_inject_rx(sx126x_emul_get(), message, sizeof(message), DOWNLINK_RSSI, DOWNLINK_SNR) != 0)
+   {
+      LOG_ERR("Join accept not queued.");
+   }
+   else
+   {
+      LOG_INF("Join accept queued, DevAddr=%08X.", NETWORK_DEV_ADDR);
+   }
+}
+
+/**
+ * @brief Packet transmitted by the emulated radio.
+ */
+static void NetworkEmulTxHandler(const struct emul *target, const uint8_t *payload, uint8_t size,
+                                 uint32_t freqHz, void *userData)
+{
+   if (size == 0)
+   {
+      return;
+   }
+
+   switch (payload[0] & MHDR_TYPE_MASK)
+   {
+      case MHDR_JOIN_REQUEST:
+         if (size == JOIN_REQUEST_SIZE)
+         {
+            joinDevNonce = sys_get_le16(&payload[JOIN_REQUEST_DEVNONCE]);
+            LOG_INF("Join request on %u Hz, DevNonce=%u.", freqHz, joinDevNonce);
+            k_work_submit(&joinAcceptWork);
+         }
+         break;
+
+      case MHDR_UNCONFIRMED_UP:
+      case MHDR_CONFIRMED_UP:
+         if (size >= UPLINK_MIN_SIZE)
+         {
+            LOG_INF("%s uplink on %u Hz, DevAddr=%08X FCnt=%u, %u bytes.",
+                    ((payload[0] & MHDR_TYPE_MASK) == MHDR_CONFIRMED_UP) ? "Confirmed" : "Unconfirmed",
+                    freqHz, sys_get_le32(&payload[1]), sys_get_le16(&payload[6]), size);
+         }
+         break;
+
+      default:
+         LOG_WRN("Unexpected MHDR: 0x%02X", payload[0]);
+         break;
+   }
+}
+
+static int NetworkEmulInit(void)
+{
+   const struct emul *radio = sx126x_emul_get();
+
+   if (radio == NULL)
+   {
+      LOG_ERR("No emulated radio.");
+      return -ENODEV;
+   }
+
+   k_work_init(&joinAcceptWork, NetworkEmulJoinAccept);
+   sx126x_emul_set_tx_callback(radio, NetworkEmulTxHandler, NULL);
+
+   return 0;
+}
+
+SYS_INIT(NetworkEmulInit, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
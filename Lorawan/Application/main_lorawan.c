@@ -66,6 +66,7 @@
 #include "smtc_modem_api_str.h"
 
 #include "sx126x_hal_context.h"
+#include "smtc_modem_hal_ext.h"
 #include "modem_context.h"
 
 #include <zephyr/kernel.h>
@@ -161,6 +162,20 @@ static void on_modem_tx_done(smtc_modem_event_txdone_status_t status);
 static void on_modem_down_data(int8_t rssi, int8_t snr, smtc_modem_event_downdata_window_t rx_window, uint8_t port,
                                const uint8_t *payload, uint8_t size);
 
+/*!
+ * @brief Time updated event callback.
+ *
+ * @param [in] status time status @ref smtc_modem_event_time_status_t
+ */
+static void on_modem_time_updated(smtc_modem_event_time_status_t status);
+
+#if defined(CONFIG_LBM_MODEM_HAL_WATCHDOG)
+/*!
+ * @brief Modem event callback, timed by the modem HAL supervisor
+ */
+static void modem_event_process(void);
+#endif
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
@@ -184,7 +199,7 @@ int main(void)
       .reset                 = on_modem_reset,
       .set_conf              = NULL,
       .stream_done           = NULL,
-      .time_updated_alc_sync = NULL,
+      .time_updated_alc_sync = on_modem_time_updated,
       .tx_done               = on_modem_tx_done,
       .upload_done           = NULL,
    };
@@ -194,6 +209,19 @@ int main(void)
    /* Initialise the ralf_t object corresponding to the board */
    ralf_t *modem_radio = smtc_board_initialise_and_get_ralf();
 
+#if defined(CONFIG_LBM_MODEM_HAL_BOARD_DELAY_CALIBRATION)
+   /* Measure the radio command latency once per board, it is stored in the settings. */
+   smtc_modem_hal_board_delay_calibrate(modem_radio->ral.context);
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_RECOVERY)
+   /* Resumed here after a modem assert, to initialize the modem again. */
+   if (SMTC_MODEM_HAL_RECOVERY_POINT() != 0)
+   {
+      LOG_WRN("Modem restarted after an assert.");
+   }
+#endif
+
    /* Disable IRQ to avoid unwanted behaviour during init */
    key = irq_lock();
 
@@ -202,11 +230,20 @@ int main(void)
 
    /* Init the modem and use apps_modem_event_process as event callback. Please note that the callback
     * will be called immediately after the first call to modem_run_engine because of the reset detection. */
+#if defined(CONFIG_LBM_MODEM_HAL_WATCHDOG)
+   smtc_modem_init(modem_radio, &modem_event_process);
+#else
    smtc_modem_init(modem_radio, &apps_modem_event_process);
+#endif
 
    /* Re-enable IRQ */
    irq_unlock(key);
 
+#if defined(CONFIG_LBM_MODEM_HAL_RECOVERY)
+   /* An assert in the init resets the MCU, one after it is recovered in place. */
+   smtc_modem_hal_recovery_init_done();
+#endif
+
    LOG_INF("###### ===== LoRa Basics Modem LoRaWAN Class A/C demo application ==== ######");
    LOG_INF("Version 1.0  Build: %s %s", __DATE__, __TIME__);
    apps_modem_common_display_version_information();
@@ -216,7 +253,21 @@ int main(void)
    while (1)
    {
       /* Execute modem runtime, this function must be called again in sleep_time_ms milliseconds or sooner. */
+#if defined(CONFIG_LBM_MODEM_HAL_WATCHDOG)
+      uint32_t pass_start = smtc_modem_hal_supervisor_begin(SMTC_MODEM_HAL_SUPERVISOR_ENGINE);
       uint32_t sleep_time_ms = smtc_modem_run_engine();
+      smtc_modem_hal_supervisor_end(SMTC_MODEM_HAL_SUPERVISOR_ENGINE, pass_start);
+
+      /* Wake up in time to feed the watchdog. */
+      sleep_time_ms = smtc_modem_hal_watchdog_sleep_ms(sleep_time_ms);
+#else
+      uint32_t sleep_time_ms = smtc_modem_run_engine();
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_FLASH_SCHED)
+      /* Let the deferred flash writes run while the radio is idle. */
+      smtc_modem_hal_flash_idle(sleep_time_ms);
+#endif
 
       /* go in low power */
       k_sleep(K_MSEC(sleep_time_ms));
@@ -228,6 +279,16 @@ int main(void)
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
  */
 
+#if defined(CONFIG_LBM_MODEM_HAL_WATCHDOG)
+static void modem_event_process(void)
+{
+   uint32_t start = smtc_modem_hal_supervisor_begin(SMTC_MODEM_HAL_SUPERVISOR_EVENT);
+
+   apps_modem_event_process();
+   smtc_modem_hal_supervisor_end(SMTC_MODEM_HAL_SUPERVISOR_EVENT, start);
+}
+#endif
+
 static void on_modem_reset(uint16_t reset_count)
 {
    LOG_INF("Application parameters:");
@@ -282,6 +343,9 @@ static void on_modem_tx_done(smtc_modem_event_txdone_status_t status)
    {
       LOG_INF("Uplink count: %d", uplink_count);
       ++uplink_count;
+#if defined(CONFIG_LBM_MODEM_HAL_RECOVERY)
+      smtc_modem_hal_recovery_uplink_done();
+#endif
    }
 }
 
@@ -319,6 +383,24 @@ static void on_modem_down_data(int8_t rssi, int8_t snr, smtc_modem_event_downdat
    }
 }
 
+static void on_modem_time_updated(smtc_modem_event_time_status_t status)
+{
+#if defined(CONFIG_LBM_MODEM_HAL_DRIFT)
+   uint32_t gps_time_s       = 0;
+   uint32_t gps_fractional_s = 0;
+
+   /* Learn the clock drift from the network time, and narrow the RX windows accordingly */
+   if ((status == SMTC_MODEM_EVENT_TIME_VALID) &&
+       (smtc_modem_get_time(&gps_time_s, &gps_fractional_s) == SMTC_MODEM_RC_OK))
+   {
+      smtc_modem_hal_drift_sync(gps_time_s, gps_fractional_s);
+      ASSERT_SMTC_MODEM_RC(smtc_modem_set_crystal_error_ppm(smtc_modem_hal_drift_get_clock_error_ppm()));
+      LOG_INF("Clock drift: %d ppb, residual %u ppm, clock error %u ppm", smtc_modem_hal_drift_get_ppb(),
+              smtc_modem_hal_drift_get_residual_ppm(), smtc_modem_hal_drift_get_clock_error_ppm());
+   }
+#endif
+}
+
 static void send_frame(const uint8_t *buffer, const uint8_t length, bool tx_confirmed)
 {
    uint8_t tx_max_payload;
@@ -47,774 +47,261 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
- #include "smtc_modem_api_str.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
 
-const char *smtc_modem_return_code_to_str(const smtc_modem_return_code_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_RC_OK:
-      {
-         return (const char *) "SMTC_MODEM_RC_OK";
-      }
-
-      case SMTC_MODEM_RC_NOT_INIT:
-      {
-         return (const char *) "SMTC_MODEM_RC_NOT_INIT";
-      }
-
-      case SMTC_MODEM_RC_INVALID:
-      {
-         return (const char *) "SMTC_MODEM_RC_INVALID";
-      }
-
-      case SMTC_MODEM_RC_BUSY:
-      {
-         return (const char *) "SMTC_MODEM_RC_BUSY";
-      }
-
-      case SMTC_MODEM_RC_FAIL:
-      {
-         return (const char *) "SMTC_MODEM_RC_FAIL";
-      }
-
-      case SMTC_MODEM_RC_BAD_SIZE:
-      {
-         return (const char *) "SMTC_MODEM_RC_BAD_SIZE";
-      }
-
-      case SMTC_MODEM_RC_MODEM_E_FRAME_ERROR:
-      {
-         return (const char *) "SMTC_MODEM_RC_MODEM_E_FRAME_ERROR";
-      }
-
-      case SMTC_MODEM_RC_NO_TIME:
-      {
-         return (const char *) "SMTC_MODEM_RC_NO_TIME";
-      }
-
-      case SMTC_MODEM_RC_INVALID_STACK_ID:
-      {
-         return (const char *) "SMTC_MODEM_RC_INVALID_STACK_ID";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_adr_profile_to_str(const smtc_modem_adr_profile_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_ADR_PROFILE_NETWORK_CONTROLLED:
-      {
-         return (const char *) "SMTC_MODEM_ADR_PROFILE_NETWORK_CONTROLLED";
-      }
-
-      case SMTC_MODEM_ADR_PROFILE_MOBILE_LONG_RANGE:
-      {
-         return (const char *) "SMTC_MODEM_ADR_PROFILE_MOBILE_LONG_RANGE";
-      }
-
-      case SMTC_MODEM_ADR_PROFILE_MOBILE_LOW_POWER:
-      {
-         return (const char *) "SMTC_MODEM_ADR_PROFILE_MOBILE_LOW_POWER";
-      }
-
-      case SMTC_MODEM_ADR_PROFILE_CUSTOM:
-      {
-         return (const char *) "SMTC_MODEM_ADR_PROFILE_CUSTOM";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_class_to_str(const smtc_modem_class_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_CLASS_A:
-      {
-         return (const char *) "SMTC_MODEM_CLASS_A";
-      }
-
-      case SMTC_MODEM_CLASS_B:
-      {
-         return (const char *) "SMTC_MODEM_CLASS_B";
-      }
-
-      case SMTC_MODEM_CLASS_C:
-      {
-         return (const char *) "SMTC_MODEM_CLASS_C";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_file_upload_cipher_mode_to_str(const smtc_modem_file_upload_cipher_mode_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_FILE_UPLOAD_NO_CIPHER:
-      {
-         return (const char *) "SMTC_MODEM_FILE_UPLOAD_NO_CIPHER";
-      }
-
-      case SMTC_MODEM_FILE_UPLOAD_AES_WITH_APPSKEY:
-      {
-         return (const char *) "SMTC_MODEM_FILE_UPLOAD_AES_WITH_APPSKEY";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_stream_cipher_mode_to_str(const smtc_modem_stream_cipher_mode_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_STREAM_NO_CIPHER:
-      {
-         return (const char *) "SMTC_MODEM_STREAM_NO_CIPHER";
-      }
-
-      case SMTC_MODEM_STREAM_AES_WITH_APPSKEY:
-      {
-         return (const char *) "SMTC_MODEM_STREAM_AES_WITH_APPSKEY";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_dm_info_interval_format_to_str(const smtc_modem_dm_info_interval_format_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_DM_INFO_INTERVAL_IN_SECOND:
-      {
-         return (const char *) "SMTC_MODEM_DM_INFO_INTERVAL_IN_SECOND";
-      }
-
-      case SMTC_MODEM_DM_INFO_INTERVAL_IN_DAY:
-      {
-         return (const char *) "SMTC_MODEM_DM_INFO_INTERVAL_IN_DAY";
-      }
-
-      case SMTC_MODEM_DM_INFO_INTERVAL_IN_HOUR:
-      {
-         return (const char *) "SMTC_MODEM_DM_INFO_INTERVAL_IN_HOUR";
-      }
-
-      case SMTC_MODEM_DM_INFO_INTERVAL_IN_MINUTE:
-      {
-         return (const char *) "SMTC_MODEM_DM_INFO_INTERVAL_IN_MINUTE";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_region_to_str(const smtc_modem_region_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_REGION_EU_868:
-      {
-         return (const char *) "SMTC_MODEM_REGION_EU_868";
-      }
-
-      case SMTC_MODEM_REGION_AS_923_GRP1:
-      {
-         return (const char *) "SMTC_MODEM_REGION_AS_923_GRP1";
-      }
-
-      case SMTC_MODEM_REGION_US_915:
-      {
-         return (const char *) "SMTC_MODEM_REGION_US_915";
-      }
-
-      case SMTC_MODEM_REGION_AU_915:
-      {
-         return (const char *) "SMTC_MODEM_REGION_AU_915";
-      }
-
-      case SMTC_MODEM_REGION_CN_470:
-      {
-         return (const char *) "SMTC_MODEM_REGION_CN_470";
-      }
-
-      case SMTC_MODEM_REGION_WW2G4:
-      {
-         return (const char *) "SMTC_MODEM_REGION_WW2G4";
-      }
-
-      case SMTC_MODEM_REGION_AS_923_GRP2:
-      {
-         return (const char *) "SMTC_MODEM_REGION_AS_923_GRP2";
-      }
-
-      case SMTC_MODEM_REGION_AS_923_GRP3:
-      {
-         return (const char *) "SMTC_MODEM_REGION_AS_923_GRP3";
-      }
-
-      case SMTC_MODEM_REGION_IN_865:
-      {
-         return (const char *) "SMTC_MODEM_REGION_IN_865";
-      }
-
-      case SMTC_MODEM_REGION_KR_920:
-      {
-         return (const char *) "SMTC_MODEM_REGION_KR_920";
-      }
-
-      case SMTC_MODEM_REGION_RU_864:
-      {
-         return (const char *) "SMTC_MODEM_REGION_RU_864";
-      }
-
-      case SMTC_MODEM_REGION_CN_470_RP_1_0:
-      {
-         return (const char *) "SMTC_MODEM_REGION_CN_470_RP_1_0";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_mc_grp_id_to_str(const smtc_modem_mc_grp_id_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_MC_GRP_0:
-      {
-         return (const char *) "SMTC_MODEM_MC_GRP_0";
-      }
-
-      case SMTC_MODEM_MC_GRP_1:
-      {
-         return (const char *) "SMTC_MODEM_MC_GRP_1";
-      }
-
-      case SMTC_MODEM_MC_GRP_2:
-      {
-         return (const char *) "SMTC_MODEM_MC_GRP_2";
-      }
-
-      case SMTC_MODEM_MC_GRP_3:
-      {
-         return (const char *) "SMTC_MODEM_MC_GRP_3";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_stack_state_to_str(const smtc_modem_stack_state_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_STACK_STATE_IDLE:
-      {
-         return (const char *) "SMTC_MODEM_STACK_STATE_IDLE";
-      }
-
-      case SMTC_MODEM_STACK_STATE_BUSY:
-      {
-         return (const char *) "SMTC_MODEM_STACK_STATE_BUSY";
-      }
-
-      case SMTC_MODEM_STACK_STATE_TX_WAIT:
-      {
-         return (const char *) "SMTC_MODEM_STACK_STATE_TX_WAIT";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_event_downdata_window_to_str(const smtc_modem_event_downdata_window_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RX1:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RX1";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RX2:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RX2";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP0:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP0";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP1:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP1";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP2:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP2";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP3:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP3";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP0:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP0";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP1:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP1";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP2:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP2";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP3:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP3";
-      }
-
-      case SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXBEACON:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXBEACON";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
+#include "smtc_modem_api_str.h"
 
-const char *smtc_modem_time_sync_service_to_str(const smtc_modem_time_sync_service_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_TIME_MAC_SYNC:
-      {
-         return (const char *) "SMTC_MODEM_TIME_MAC_SYNC";
-      }
-
-      case SMTC_MODEM_TIME_ALC_SYNC:
-      {
-         return (const char *) "SMTC_MODEM_TIME_ALC_SYNC";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_event_time_status_to_str(const smtc_modem_event_time_status_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_TIME_NOT_VALID:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_TIME_NOT_VALID";
-      }
-
-      case SMTC_MODEM_EVENT_TIME_VALID:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_TIME_VALID";
-      }
-
-      case SMTC_MODEM_EVENT_TIME_VALID_BUT_NOT_SYNC:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_TIME_VALID_BUT_NOT_SYNC";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_event_link_check_status_to_str(const smtc_modem_event_link_check_status_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_LINK_CHECK_NOT_RECEIVED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_LINK_CHECK_NOT_RECEIVED";
-      }
-
-      case SMTC_MODEM_EVENT_LINK_CHECK_RECEIVED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_LINK_CHECK_RECEIVED";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_event_txdone_status_to_str(const smtc_modem_event_txdone_status_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_TXDONE_NOT_SENT:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_TXDONE_NOT_SENT";
-      }
-
-      case SMTC_MODEM_EVENT_TXDONE_SENT:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_TXDONE_SENT";
-      }
-
-      case SMTC_MODEM_EVENT_TXDONE_CONFIRMED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_TXDONE_CONFIRMED";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_event_mute_status_to_str(const smtc_modem_event_mute_status_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_MUTE_OFF:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_MUTE_OFF";
-      }
-
-      case SMTC_MODEM_EVENT_MUTE_ON:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_MUTE_ON";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS ----------------------------------------------------------
+ */
 
-const char *smtc_modem_event_uploaddone_status_to_str(const smtc_modem_event_uploaddone_status_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_UPLOADDONE_ABORTED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_UPLOADDONE_ABORTED";
-      }
-
-      case SMTC_MODEM_EVENT_UPLOADDONE_SUCCESSFUL:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_UPLOADDONE_SUCCESSFUL";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
+// Table entry indexed by the enumeration value.
+#define API_STR_ENTRY(value)        [value] = #value,
 
-const char *smtc_modem_event_setconf_tag_to_str(const smtc_modem_event_setconf_tag_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_SETCONF_ADR_MODE_UPDATED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_SETCONF_ADR_MODE_UPDATED";
-      }
-
-      case SMTC_MODEM_EVENT_SETCONF_JOIN_EUI_UPDATED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_SETCONF_JOIN_EUI_UPDATED";
-      }
-
-      case SMTC_MODEM_EVENT_SETCONF_DM_INTERVAL_UPDATED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_SETCONF_DM_INTERVAL_UPDATED";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
+// Function returning the name of an enumeration value from a table indexed by the value.
+#define API_STR_TABLE(function, type, list)                                      \
+   const char *function(const type value)                                       \
+   {                                                                            \
+      static const char *const names[] = {list(API_STR_ENTRY)};                 \
+                                                                                \
+      return ApiStrLookup(names, ARRAY_SIZE(names), (uint32_t) value);          \
    }
-}
 
-const char *smtc_modem_event_almanac_update_status_to_str(const smtc_modem_event_almanac_update_status_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_ALMANAC_UPDATE_COMPLETED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_ALMANAC_UPDATE_COMPLETED";
-      }
-
-      case SMTC_MODEM_EVENT_ALMANAC_UPDATE_STATUS_REQUESTED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_ALMANAC_UPDATE_STATUS_REQUESTED";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
+// Function compiled out with its log level: the names aren't linked in.
+#define API_STR_NONE(function, type, list)                                       \
+   const char *function(const type value)                                       \
+   {                                                                            \
+      ARG_UNUSED(value);                                                        \
+      return "";                                                                \
    }
-}
 
-const char *smtc_modem_event_class_b_status_to_str(const smtc_modem_event_class_b_status_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_CLASS_B_NOT_READY:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_CLASS_B_NOT_READY";
-      }
-
-      case SMTC_MODEM_EVENT_CLASS_B_READY:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_CLASS_B_READY";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
-
-const char *smtc_modem_event_class_b_ping_slot_status_to_str(const smtc_modem_event_class_b_ping_slot_status_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_CLASS_B_PING_SLOT_NOT_ANSWERED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_CLASS_B_PING_SLOT_NOT_ANSWERED";
-      }
-
-      case SMTC_MODEM_EVENT_CLASS_B_PING_SLOT_ANSWERED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_CLASS_B_PING_SLOT_ANSWERED";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
+// Each function is compiled with the lowest log level that prints its names.
+#if CONFIG_LBM_LOG_LEVEL >= LOG_LEVEL_ERR
+#define API_STR_ERR                 API_STR_TABLE
+#else
+#define API_STR_ERR                 API_STR_NONE
+#endif
+
+#if CONFIG_LBM_LOG_LEVEL >= LOG_LEVEL_INF
+#define API_STR_INF                 API_STR_TABLE
+#else
+#define API_STR_INF                 API_STR_NONE
+#endif
+
+#if CONFIG_LBM_LOG_LEVEL >= LOG_LEVEL_DBG
+#define API_STR_DBG                 API_STR_TABLE
+#else
+#define API_STR_DBG                 API_STR_NONE
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
 
-const char *smtc_modem_event_user_radio_access_status_to_str(const smtc_modem_event_user_radio_access_status_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_USER_RADIO_ACCESS_RX_ERROR:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_USER_RADIO_ACCESS_RX_ERROR";
-      }
-
-      case SMTC_MODEM_EVENT_USER_RADIO_ACCESS_CAD_OK:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_USER_RADIO_ACCESS_CAD_OK";
-      }
-
-      case SMTC_MODEM_EVENT_USER_RADIO_ACCESS_CAD_DONE:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_USER_RADIO_ACCESS_CAD_DONE";
-      }
-
-      case SMTC_MODEM_EVENT_USER_RADIO_ACCESS_TX_DONE:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_USER_RADIO_ACCESS_TX_DONE";
-      }
-
-      case SMTC_MODEM_EVENT_USER_RADIO_ACCESS_RX_DONE:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_USER_RADIO_ACCESS_RX_DONE";
-      }
-
-      case SMTC_MODEM_EVENT_USER_RADIO_ACCESS_RX_TIMEOUT:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_USER_RADIO_ACCESS_RX_TIMEOUT";
-      }
-
-      case SMTC_MODEM_EVENT_USER_RADIO_ACCESS_WIFI_SCAN_DONE:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_USER_RADIO_ACCESS_WIFI_SCAN_DONE";
-      }
-
-      case SMTC_MODEM_EVENT_USER_RADIO_ACCESS_GNSS_SCAN_DONE:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_USER_RADIO_ACCESS_GNSS_SCAN_DONE";
-      }
-
-      case SMTC_MODEM_EVENT_USER_RADIO_ACCESS_ABORTED:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_USER_RADIO_ACCESS_ABORTED";
-      }
-
-      case SMTC_MODEM_EVENT_USER_RADIO_ACCESS_UNKNOWN:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_USER_RADIO_ACCESS_UNKNOWN";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
+#define SMTC_MODEM_RETURN_CODE_LIST(X) \
+   X(SMTC_MODEM_RC_OK) \
+   X(SMTC_MODEM_RC_NOT_INIT) \
+   X(SMTC_MODEM_RC_INVALID) \
+   X(SMTC_MODEM_RC_BUSY) \
+   X(SMTC_MODEM_RC_FAIL) \
+   X(SMTC_MODEM_RC_BAD_SIZE) \
+   X(SMTC_MODEM_RC_MODEM_E_FRAME_ERROR) \
+   X(SMTC_MODEM_RC_NO_TIME) \
+   X(SMTC_MODEM_RC_INVALID_STACK_ID)
+
+#define SMTC_MODEM_ADR_PROFILE_LIST(X) \
+   X(SMTC_MODEM_ADR_PROFILE_NETWORK_CONTROLLED) \
+   X(SMTC_MODEM_ADR_PROFILE_MOBILE_LONG_RANGE) \
+   X(SMTC_MODEM_ADR_PROFILE_MOBILE_LOW_POWER) \
+   X(SMTC_MODEM_ADR_PROFILE_CUSTOM)
+
+#define SMTC_MODEM_CLASS_LIST(X) \
+   X(SMTC_MODEM_CLASS_A) \
+   X(SMTC_MODEM_CLASS_B) \
+   X(SMTC_MODEM_CLASS_C)
+
+#define SMTC_MODEM_FILE_UPLOAD_CIPHER_MODE_LIST(X) \
+   X(SMTC_MODEM_FILE_UPLOAD_NO_CIPHER) \
+   X(SMTC_MODEM_FILE_UPLOAD_AES_WITH_APPSKEY)
+
+#define SMTC_MODEM_STREAM_CIPHER_MODE_LIST(X) \
+   X(SMTC_MODEM_STREAM_NO_CIPHER) \
+   X(SMTC_MODEM_STREAM_AES_WITH_APPSKEY)
+
+#define SMTC_MODEM_DM_INFO_INTERVAL_FORMAT_LIST(X) \
+   X(SMTC_MODEM_DM_INFO_INTERVAL_IN_SECOND) \
+   X(SMTC_MODEM_DM_INFO_INTERVAL_IN_DAY) \
+   X(SMTC_MODEM_DM_INFO_INTERVAL_IN_HOUR) \
+   X(SMTC_MODEM_DM_INFO_INTERVAL_IN_MINUTE)
+
+#define SMTC_MODEM_REGION_LIST(X) \
+   X(SMTC_MODEM_REGION_EU_868) \
+   X(SMTC_MODEM_REGION_AS_923_GRP1) \
+   X(SMTC_MODEM_REGION_US_915) \
+   X(SMTC_MODEM_REGION_AU_915) \
+   X(SMTC_MODEM_REGION_CN_470) \
+   X(SMTC_MODEM_REGION_WW2G4) \
+   X(SMTC_MODEM_REGION_AS_923_GRP2) \
+   X(SMTC_MODEM_REGION_AS_923_GRP3) \
+   X(SMTC_MODEM_REGION_IN_865) \
+   X(SMTC_MODEM_REGION_KR_920) \
+   X(SMTC_MODEM_REGION_RU_864) \
+   X(SMTC_MODEM_REGION_CN_470_RP_1_0)
+
+#define SMTC_MODEM_MC_GRP_ID_LIST(X) \
+   X(SMTC_MODEM_MC_GRP_0) \
+   X(SMTC_MODEM_MC_GRP_1) \
+   X(SMTC_MODEM_MC_GRP_2) \
+   X(SMTC_MODEM_MC_GRP_3)
+
+#define SMTC_MODEM_STACK_STATE_LIST(X) \
+   X(SMTC_MODEM_STACK_STATE_IDLE) \
+   X(SMTC_MODEM_STACK_STATE_BUSY) \
+   X(SMTC_MODEM_STACK_STATE_TX_WAIT)
+
+#define SMTC_MODEM_EVENT_DOWNDATA_WINDOW_LIST(X) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RX1) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RX2) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP0) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP1) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP2) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXC_MC_GRP3) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP0) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP1) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP2) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXB_MC_GRP3) \
+   X(SMTC_MODEM_EVENT_DOWNDATA_WINDOW_RXBEACON)
+
+#define SMTC_MODEM_TIME_SYNC_SERVICE_LIST(X) \
+   X(SMTC_MODEM_TIME_MAC_SYNC) \
+   X(SMTC_MODEM_TIME_ALC_SYNC)
+
+#define SMTC_MODEM_EVENT_TIME_STATUS_LIST(X) \
+   X(SMTC_MODEM_EVENT_TIME_NOT_VALID) \
+   X(SMTC_MODEM_EVENT_TIME_VALID) \
+   X(SMTC_MODEM_EVENT_TIME_VALID_BUT_NOT_SYNC)
+
+#define SMTC_MODEM_EVENT_LINK_CHECK_STATUS_LIST(X) \
+   X(SMTC_MODEM_EVENT_LINK_CHECK_NOT_RECEIVED) \
+   X(SMTC_MODEM_EVENT_LINK_CHECK_RECEIVED)
+
+#define SMTC_MODEM_EVENT_TXDONE_STATUS_LIST(X) \
+   X(SMTC_MODEM_EVENT_TXDONE_NOT_SENT) \
+   X(SMTC_MODEM_EVENT_TXDONE_SENT) \
+   X(SMTC_MODEM_EVENT_TXDONE_CONFIRMED)
+
+#define SMTC_MODEM_EVENT_MUTE_STATUS_LIST(X) \
+   X(SMTC_MODEM_EVENT_MUTE_OFF) \
+   X(SMTC_MODEM_EVENT_MUTE_ON)
+
+#define SMTC_MODEM_EVENT_UPLOADDONE_STATUS_LIST(X) \
+   X(SMTC_MODEM_EVENT_UPLOADDONE_ABORTED) \
+   X(SMTC_MODEM_EVENT_UPLOADDONE_SUCCESSFUL)
+
+#define SMTC_MODEM_EVENT_SETCONF_TAG_LIST(X) \
+   X(SMTC_MODEM_EVENT_SETCONF_ADR_MODE_UPDATED) \
+   X(SMTC_MODEM_EVENT_SETCONF_JOIN_EUI_UPDATED) \
+   X(SMTC_MODEM_EVENT_SETCONF_DM_INTERVAL_UPDATED)
+
+#define SMTC_MODEM_EVENT_ALMANAC_UPDATE_STATUS_LIST(X) \
+   X(SMTC_MODEM_EVENT_ALMANAC_UPDATE_COMPLETED) \
+   X(SMTC_MODEM_EVENT_ALMANAC_UPDATE_STATUS_REQUESTED)
+
+#define SMTC_MODEM_EVENT_CLASS_B_STATUS_LIST(X) \
+   X(SMTC_MODEM_EVENT_CLASS_B_NOT_READY) \
+   X(SMTC_MODEM_EVENT_CLASS_B_READY)
+
+#define SMTC_MODEM_EVENT_CLASS_B_PING_SLOT_STATUS_LIST(X) \
+   X(SMTC_MODEM_EVENT_CLASS_B_PING_SLOT_NOT_ANSWERED) \
+   X(SMTC_MODEM_EVENT_CLASS_B_PING_SLOT_ANSWERED)
+
+#define SMTC_MODEM_EVENT_USER_RADIO_ACCESS_STATUS_LIST(X) \
+   X(SMTC_MODEM_EVENT_USER_RADIO_ACCESS_RX_ERROR) \
+   X(SMTC_MODEM_EVENT_USER_RADIO_ACCESS_CAD_OK) \
+   X(SMTC_MODEM_EVENT_USER_RADIO_ACCESS_CAD_DONE) \
+   X(SMTC_MODEM_EVENT_USER_RADIO_ACCESS_TX_DONE) \
+   X(SMTC_MODEM_EVENT_USER_RADIO_ACCESS_RX_DONE) \
+   X(SMTC_MODEM_EVENT_USER_RADIO_ACCESS_RX_TIMEOUT) \
+   X(SMTC_MODEM_EVENT_USER_RADIO_ACCESS_WIFI_SCAN_DONE) \
+   X(SMTC_MODEM_EVENT_USER_RADIO_ACCESS_GNSS_SCAN_DONE) \
+   X(SMTC_MODEM_EVENT_USER_RADIO_ACCESS_ABORTED) \
+   X(SMTC_MODEM_EVENT_USER_RADIO_ACCESS_UNKNOWN)
+
+#define SMTC_MODEM_CLASS_B_PING_SLOT_PERIODICITY_LIST(X) \
+   X(SMTC_MODEM_CLASS_B_PINGSLOT_1_S) \
+   X(SMTC_MODEM_CLASS_B_PINGSLOT_2_S) \
+   X(SMTC_MODEM_CLASS_B_PINGSLOT_4_S) \
+   X(SMTC_MODEM_CLASS_B_PINGSLOT_8_S) \
+   X(SMTC_MODEM_CLASS_B_PINGSLOT_16_S) \
+   X(SMTC_MODEM_CLASS_B_PINGSLOT_32_S) \
+   X(SMTC_MODEM_CLASS_B_PINGSLOT_64_S) \
+   X(SMTC_MODEM_CLASS_B_PINGSLOT_128_S)
+
+#define SMTC_MODEM_FRAME_PENDING_BIT_STATUS_LIST(X) \
+   X(SMTC_MODEM_NO_DATA_ARE_PENDING) \
+   X(SMTC_MODEM_DATA_ARE_PENDING)
+
+#define SMTC_MODEM_D2D_CLASS_B_TX_DONE_STATUS_LIST(X) \
+   X(SMTC_MODEM_EVENT_D2D_CLASS_B_TX_DONE_NOT_SENT) \
+   X(SMTC_MODEM_EVENT_D2D_CLASS_B_TX_DONE_SENT)
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
 
-const char *smtc_modem_class_b_ping_slot_periodicity_to_str(const smtc_modem_class_b_ping_slot_periodicity_t value)
+/**
+ * @brief Get a name from a table indexed by the enumeration value.
+ *
+ * @param [in] names Names, NULL for the values without one.
+ * @param [in] count Number of names.
+ * @param [in] value Enumeration value.
+ *
+ * @return Name, "Unknown" if the value hasn't one.
+ */
+static inline const char *ApiStrLookup(const char *const *names, const size_t count, const uint32_t value)
 {
-   switch (value)
+   if ((value < count) && (names[value] != NULL))
    {
-      case SMTC_MODEM_CLASS_B_PINGSLOT_1_S:
-      {
-         return (const char *) "SMTC_MODEM_CLASS_B_PINGSLOT_1_S";
-      }
-
-      case SMTC_MODEM_CLASS_B_PINGSLOT_2_S:
-      {
-         return (const char *) "SMTC_MODEM_CLASS_B_PINGSLOT_2_S";
-      }
-
-      case SMTC_MODEM_CLASS_B_PINGSLOT_4_S:
-      {
-         return (const char *) "SMTC_MODEM_CLASS_B_PINGSLOT_4_S";
-      }
-
-      case SMTC_MODEM_CLASS_B_PINGSLOT_8_S:
-      {
-         return (const char *) "SMTC_MODEM_CLASS_B_PINGSLOT_8_S";
-      }
-
-      case SMTC_MODEM_CLASS_B_PINGSLOT_16_S:
-      {
-         return (const char *) "SMTC_MODEM_CLASS_B_PINGSLOT_16_S";
-      }
-
-      case SMTC_MODEM_CLASS_B_PINGSLOT_32_S:
-      {
-         return (const char *) "SMTC_MODEM_CLASS_B_PINGSLOT_32_S";
-      }
-
-      case SMTC_MODEM_CLASS_B_PINGSLOT_64_S:
-      {
-         return (const char *) "SMTC_MODEM_CLASS_B_PINGSLOT_64_S";
-      }
-
-      case SMTC_MODEM_CLASS_B_PINGSLOT_128_S:
-      {
-         return (const char *) "SMTC_MODEM_CLASS_B_PINGSLOT_128_S";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
+      return names[value];
    }
-}
 
-const char *smtc_modem_frame_pending_bit_status_to_str(const smtc_modem_frame_pending_bit_status_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_NO_DATA_ARE_PENDING:
-      {
-         return (const char *) "SMTC_MODEM_NO_DATA_ARE_PENDING";
-      }
-
-      case SMTC_MODEM_DATA_ARE_PENDING:
-      {
-         return (const char *) "SMTC_MODEM_DATA_ARE_PENDING";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
+   return "Unknown";
 }
 
-const char *smtc_modem_d2d_class_b_tx_done_status_to_str(const smtc_modem_d2d_class_b_tx_done_status_t value)
-{
-   switch (value)
-   {
-      case SMTC_MODEM_EVENT_D2D_CLASS_B_TX_DONE_NOT_SENT:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_D2D_CLASS_B_TX_DONE_NOT_SENT";
-      }
-
-      case SMTC_MODEM_EVENT_D2D_CLASS_B_TX_DONE_SENT:
-      {
-         return (const char *) "SMTC_MODEM_EVENT_D2D_CLASS_B_TX_DONE_SENT";
-      }
-
-      default:
-      {
-         return (const char *) "Unknown";
-      }
-   }
-}
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
 
+API_STR_ERR(smtc_modem_return_code_to_str, smtc_modem_return_code_t, SMTC_MODEM_RETURN_CODE_LIST)
+API_STR_DBG(smtc_modem_adr_profile_to_str, smtc_modem_adr_profile_t, SMTC_MODEM_ADR_PROFILE_LIST)
+API_STR_INF(smtc_modem_class_to_str, smtc_modem_class_t, SMTC_MODEM_CLASS_LIST)
+API_STR_DBG(smtc_modem_file_upload_cipher_mode_to_str, smtc_modem_file_upload_cipher_mode_t, SMTC_MODEM_FILE_UPLOAD_CIPHER_MODE_LIST)
+API_STR_DBG(smtc_modem_stream_cipher_mode_to_str, smtc_modem_stream_cipher_mode_t, SMTC_MODEM_STREAM_CIPHER_MODE_LIST)
+API_STR_DBG(smtc_modem_dm_info_interval_format_to_str, smtc_modem_dm_info_interval_format_t, SMTC_MODEM_DM_INFO_INTERVAL_FORMAT_LIST)
+API_STR_INF(smtc_modem_region_to_str, smtc_modem_region_t, SMTC_MODEM_REGION_LIST)
+API_STR_DBG(smtc_modem_mc_grp_id_to_str, smtc_modem_mc_grp_id_t, SMTC_MODEM_MC_GRP_ID_LIST)
+API_STR_DBG(smtc_modem_stack_state_to_str, smtc_modem_stack_state_t, SMTC_MODEM_STACK_STATE_LIST)
+API_STR_INF(smtc_modem_event_downdata_window_to_str, smtc_modem_event_downdata_window_t, SMTC_MODEM_EVENT_DOWNDATA_WINDOW_LIST)
+API_STR_DBG(smtc_modem_time_sync_service_to_str, smtc_modem_time_sync_service_t, SMTC_MODEM_TIME_SYNC_SERVICE_LIST)
+API_STR_INF(smtc_modem_event_time_status_to_str, smtc_modem_event_time_status_t, SMTC_MODEM_EVENT_TIME_STATUS_LIST)
+API_STR_INF(smtc_modem_event_link_check_status_to_str, smtc_modem_event_link_check_status_t, SMTC_MODEM_EVENT_LINK_CHECK_STATUS_LIST)
+API_STR_ERR(smtc_modem_event_txdone_status_to_str, smtc_modem_event_txdone_status_t, SMTC_MODEM_EVENT_TXDONE_STATUS_LIST)
+API_STR_INF(smtc_modem_event_mute_status_to_str, smtc_modem_event_mute_status_t, SMTC_MODEM_EVENT_MUTE_STATUS_LIST)
+API_STR_INF(smtc_modem_event_uploaddone_status_to_str, smtc_modem_event_uploaddone_status_t, SMTC_MODEM_EVENT_UPLOADDONE_STATUS_LIST)
+API_STR_INF(smtc_modem_event_setconf_tag_to_str, smtc_modem_event_setconf_tag_t, SMTC_MODEM_EVENT_SETCONF_TAG_LIST)
+API_STR_INF(smtc_modem_event_almanac_update_status_to_str, smtc_modem_event_almanac_update_status_t, SMTC_MODEM_EVENT_ALMANAC_UPDATE_STATUS_LIST)
+API_STR_INF(smtc_modem_event_class_b_status_to_str, smtc_modem_event_class_b_status_t, SMTC_MODEM_EVENT_CLASS_B_STATUS_LIST)
+API_STR_INF(smtc_modem_event_class_b_ping_slot_status_to_str, smtc_modem_event_class_b_ping_slot_status_t, SMTC_MODEM_EVENT_CLASS_B_PING_SLOT_STATUS_LIST)
+API_STR_DBG(smtc_modem_event_user_radio_access_status_to_str, smtc_modem_event_user_radio_access_status_t, SMTC_MODEM_EVENT_USER_RADIO_ACCESS_STATUS_LIST)
+API_STR_DBG(smtc_modem_class_b_ping_slot_periodicity_to_str, smtc_modem_class_b_ping_slot_periodicity_t, SMTC_MODEM_CLASS_B_PING_SLOT_PERIODICITY_LIST)
+API_STR_DBG(smtc_modem_frame_pending_bit_status_to_str, smtc_modem_frame_pending_bit_status_t, SMTC_MODEM_FRAME_PENDING_BIT_STATUS_LIST)
+API_STR_DBG(smtc_modem_d2d_class_b_tx_done_status_to_str, smtc_modem_d2d_class_b_tx_done_status_t, SMTC_MODEM_D2D_CLASS_B_TX_DONE_STATUS_LIST)
@@ -63,17 +63,19 @@
 // for memcpy
 #include <string.h>
 
-#include <zephyr/settings/settings.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/sensor.h>
-#include <nrfx_gpiote.h>
 
 #include "ral_sx126x_bsp.h"
 #include "ralf_sx126x.h"
+#include "sx126x_hal.h"
 #include "sx126x_hal_context.h"
 #include "smtc_modem_hal.h"
 #include "smtc_modem_hal_dbg_trace.h"
+#include "smtc_modem_hal_ext.h"
 #include "modem_context.h"
+#include "smtc_modem_hal_internal.h"
+#include "smtc_modem_hal_time.h"
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(ModemHAL, CONFIG_LBM_LOG_LEVEL);
@@ -89,25 +91,6 @@ LOG_MODULE_REGISTER(ModemHAL, CONFIG_LBM_LOG_LEVEL);
  * --- PRIVATE CONSTANTS -------------------------------------------------------
  */
 
-#define SETTINGS_SUBTREE_NAME                "lbm_context"
-#define ADDR_FLASH_MODEM_CONTEXT             SETTINGS_SUBTREE_NAME "/modem"
-#define ADDR_FLASH_LR1MAC_CONTEXT            SETTINGS_SUBTREE_NAME "/lr1mac"
-#define ADDR_FLASH_DEVNONCE_CONTEXT          SETTINGS_SUBTREE_NAME "/devnonce"
-#define ADDR_FLASH_SECURE_ELEMENT_CONTEXT    SETTINGS_SUBTREE_NAME "/secure_element"
-
-/*
- * -----------------------------------------------------------------------------
- * --- PRIVATE TYPES -----------------------------------------------------------
- */
-
-typedef struct DirectLoadParams_s
-{
-   size_t   len;
-   void     *dest;
-   bool     fetched;
-} DirectLoadParams_t;
-
-
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE VARIABLES -------------------------------------------------------
@@ -118,7 +101,7 @@ volatile bool __attribute__((section(".noinit")))crashlog_available;
 
 static struct k_timer         halTimer;
 static bool                   halTimerIrqEnabled = false;
-static bool                   settingsSubsysInit = false;
+static bool                   halDio1IrqEnabled = false;
 static void                   (*HalTimerCallback)(void *context);
 static void                   *halTimerContext;
 
@@ -126,6 +109,28 @@ static struct gpio_callback   halDio1CallbackData;
 static void                   (*HalDio1Callback)(void *context);
 static void                   *halDio1Context;
 
+// Time of the last DIO1 interrupt, written by the interrupt handler only. The
+// sequence is odd while the time is being written, so a reader retries.
+static atomic_t               halDio1IrqSequence;
+static volatile int64_t       halDio1IrqTicks;
+
+// Cycle counter latched by the timer and DIO1 interrupt handlers.
+static uint32_t               halTimerIrqCycles;
+static uint32_t               halDio1IrqCycles;
+
+#if defined(CONFIG_LBM_MODEM_HAL_WORKQ)
+// Work queue running the modem timer and DIO1 callbacks.
+static K_THREAD_STACK_DEFINE(halWorkQueueStack, CONFIG_LBM_MODEM_HAL_WORKQ_STACK_SIZE);
+static struct k_work_q        halWorkQueue;
+static bool                   halWorkQueueInit = false;
+#endif
+
+// Last die temperature sample, refreshed by the temperature work.
+static int8_t                 temperatureC;
+static int64_t                temperatureTicks;
+static bool                   temperatureValid = false;
+static struct k_spinlock      temperatureLock;
+
 
 /*
  * -----------------------------------------------------------------------------
@@ -133,8 +138,6 @@ static void                   *halDio1Context;
  */
 static void HalTimerHandler(struct k_timer *timer);
 static void HalDio1Handler(const struct device *port, struct gpio_callback *dio1CallbackData, uint32_t pins);
-static bool InitSettingsSubsys(void);
-static int DirectLoadHandler(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg, void *param);
 
 static void HalTimerWorkHandler(struct k_work *work);
 static K_WORK_DEFINE(halTimerWorkItem, HalTimerWorkHandler);
@@ -142,7 +145,15 @@ static K_WORK_DEFINE(halTimerWorkItem, HalTimerWorkHandler);
 static void HalDio1WorkHandler(struct k_work *work);
 static K_WORK_DEFINE(halDio1WorkItem, HalDio1WorkHandler);
 
-static void TemperatureGet(struct sensor_value *temperature);
+static bool TemperatureGet(struct sensor_value *temperature);
+static int8_t TemperatureSample(void);
+static void TemperatureWorkHandler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(temperatureWork, TemperatureWorkHandler);
+
+static void HalDio1IrqTimeLatch(void);
+static bool HalDio1IrqTimeGet(int64_t *ticks);
+static void HalWorkQueueInit(void);
+static int HalWorkSubmit(struct k_work *work);
 
 
 /*
@@ -157,8 +168,10 @@ static void TemperatureGet(struct sensor_value *temperature);
  */
 void smtc_modem_hal_reset_mcu(void)
 {
+   smtc_modem_hal_context_flush();
    k_sleep(K_MSEC(2000));
-   NVIC_SystemReset();
+   SmtcModemHalRecoveryReboot();
+   SmtcModemHalPlatformReset();
 }
 
 /* ------------ Watchdog management ------------*/
@@ -171,9 +184,7 @@ void smtc_modem_hal_reset_mcu(void)
  */
 void smtc_modem_hal_reload_wdog(void)
 {
-   // @todo - Implement this if using watchdog.
-   // Example in nrf_desktop sample application, release build.
-//   int err = wdt_feed(data->wdt, data->wdt_channel_id);
+   SmtcModemHalWatchdogFeed();
 }
 
 /* ------------ Time management ------------*/
@@ -190,8 +201,7 @@ void smtc_modem_hal_reload_wdog(void)
  */
 uint32_t smtc_modem_hal_get_time_in_s(void)
 {
-   int64_t uptime64ms = k_uptime_get();
-   return (uint32_t) (uptime64ms / 1000);
+   return smtc_modem_hal_time_get_s();
 }
 
 /**
@@ -217,7 +227,7 @@ uint32_t smtc_modem_hal_get_compensated_time_in_s(void)
  */
 int32_t smtc_modem_hal_get_time_compensation_in_s(void)
 {
-   return 0;
+   return SmtcModemHalDriftCompensationS();
 }
 
 /**
@@ -228,7 +238,7 @@ int32_t smtc_modem_hal_get_time_compensation_in_s(void)
  */
 uint32_t smtc_modem_hal_get_time_in_ms(void)
 {
-   return (uint32_t) k_uptime_get();
+   return smtc_modem_hal_time_get_ms();
 }
 
 /**
@@ -241,8 +251,7 @@ uint32_t smtc_modem_hal_get_time_in_ms(void)
  */
 uint32_t smtc_modem_hal_get_time_in_100us(void)
 {
-   int64_t uptime64us = k_ticks_to_us_floor64(k_uptime_ticks());
-   return (uint32_t) (uptime64us / 100);
+   return smtc_modem_hal_time_get_100us();
 }
 
 /**
@@ -255,9 +264,16 @@ uint32_t smtc_modem_hal_get_time_in_100us(void)
  */
 uint32_t smtc_modem_hal_get_radio_irq_timestamp_in_100us(void)
 {
-   // In current LBM implementation the call of this function is done in radio_planner radio irq handler
-   // so the current time is the irq time
-   return smtc_modem_hal_get_time_in_100us();
+   int64_t irqTicks;
+
+   // The radio planner asks from the deferred DIO1 handler: return the time
+   // latched by the interrupt, not the current time.
+   if (!HalDio1IrqTimeGet(&irqTicks))
+   {
+      return smtc_modem_hal_get_time_in_100us();
+   }
+
+   return smtc_modem_hal_time_ticks_to_unit(irqTicks, 10000);
 }
 
 /* ------------ Timer management ------------*/
@@ -272,6 +288,7 @@ uint32_t smtc_modem_hal_get_radio_irq_timestamp_in_100us(void)
 void smtc_modem_hal_start_timer(const uint32_t milliseconds, void(*callback)(void *context), void *context)
 {
    LOG_DBG("Start timer for %u msec.", milliseconds);
+   HalWorkQueueInit();
    k_timer_init(&halTimer, HalTimerHandler, NULL);
    HalTimerCallback = callback;
    halTimerContext = context;
@@ -304,6 +321,7 @@ void smtc_modem_hal_disable_modem_irq(void)
    sx126x_hal_context_t const * const radioContext = modem_context_get_modem_radio_ctx();
    gpio_pin_interrupt_configure_dt(&radioContext->gpioDio1, GPIO_INT_DISABLE);
 
+   halDio1IrqEnabled = false;
    halTimerIrqEnabled = false;
 }
 
@@ -317,127 +335,47 @@ void smtc_modem_hal_enable_modem_irq(void)
    sx126x_hal_context_t const * const radioContext = modem_context_get_modem_radio_ctx();
    gpio_pin_interrupt_configure_dt(&radioContext->gpioDio1, GPIO_INT_EDGE_TO_ACTIVE);
 
+   halDio1IrqEnabled = true;
    halTimerIrqEnabled = true;
 }
 
-/* ------------ Context saving management ------------*/
-
 /**
- * @brief Restores the data context.
- *
- * @remark This function is used to restore Modem data from a non-volatile memory.
+ * @brief Check that the radio is asleep, so isn't transmitting or receiving.
  *
- * @param [in] ctx_type   Type of modem context that need to be restored.
- * @param [out] buffer    Buffer pointer to write to.
- * @param [in] size       Buffer size to read in bytes.
+ * @remark False until smtc_modem_init() gives the radio to the modem.
  */
-void smtc_modem_hal_context_restore(const modem_context_type_t ctx_type, uint8_t *buffer, const uint32_t size)
+bool SmtcModemHalRadioIdle(void)
 {
-   int rc = 0;
-   DirectLoadParams_t directLoadParams;
-
-   directLoadParams.fetched = false;
-   directLoadParams.len = size;
-   directLoadParams.dest = buffer;
+   sx126x_hal_context_t const * const radioContext = modem_context_get_modem_radio_ctx();
 
-   if (InitSettingsSubsys())
+   // No radio before smtc_modem_init(): its state is unknown.
+   if (radioContext == NULL)
    {
-      switch (ctx_type)
-      {
-         case CONTEXT_MODEM:
-            rc = settings_load_subtree_direct(ADDR_FLASH_MODEM_CONTEXT,
-                                              DirectLoadHandler,
-                                              (void *) &directLoadParams);
-            break;
-
-         case CONTEXT_LR1MAC:
-            rc = settings_load_subtree_direct(ADDR_FLASH_LR1MAC_CONTEXT,
-                                              DirectLoadHandler,
-                                              (void *) &directLoadParams);
-            break;
-
-         case CONTEXT_DEVNONCE:
-            rc = settings_load_subtree_direct(ADDR_FLASH_DEVNONCE_CONTEXT,
-                                              DirectLoadHandler,
-                                              (void *) &directLoadParams);
-            break;
-
-         case CONTEXT_SECURE_ELEMENT:
-            rc = settings_load_subtree_direct(ADDR_FLASH_SECURE_ELEMENT_CONTEXT,
-                                              DirectLoadHandler,
-                                              (void *) &directLoadParams);
-            break;
-
-         default:
-            LOG_ERR("Unknown context: %u", (uint32_t) ctx_type);
-            k_sleep(K_MSEC(200));
-            k_panic();
-            break;
-      }
-
-      if (rc != 0)
-      {
-         LOG_ERR("Settings Get Context %u. Error=%d", (uint32_t) ctx_type, rc);
-      }
-      else if (!directLoadParams.fetched)
-      {
-         rc = -ENOENT;
-      }
-      else
-      {
-         LOG_DBG("Context %u restored.", (uint32_t) ctx_type);
-      }
+      return false;
    }
+
+   return radioContext->state->radioMode == SX126X_HAL_RADIO_SLEEP;
 }
 
 /**
- * @brief Stores the data context.
- *
- * @remark This function is used to store Modem data in a non-volatile memory.
- *
- * @param [in] ctx_type   Type of modem context that need to be saved.
- * @param [in] buffer     Buffer pointer to write from.
- * @param [in] size       Buffer size to write in bytes.
+ * @brief Stop the modem timer and radio IRQ and reset the radio, before the
+ *        modem is initialized again.
  */
-void smtc_modem_hal_context_store(const modem_context_type_t ctx_type, const uint8_t *buffer, const uint32_t size)
+void SmtcModemHalQuiesce(void)
 {
-   int rc = 0;
+   sx126x_hal_context_t const * const radioContext = modem_context_get_modem_radio_ctx();
+   struct k_work_sync sync;
 
-   if (InitSettingsSubsys())
-   {
-      switch (ctx_type)
-      {
-         case CONTEXT_MODEM:
-            rc = settings_save_one(ADDR_FLASH_MODEM_CONTEXT, (void *) buffer, size);
-            break;
-
-         case CONTEXT_LR1MAC:
-            rc = settings_save_one(ADDR_FLASH_LR1MAC_CONTEXT, (void *) buffer, size);
-            break;
-
-         case CONTEXT_DEVNONCE:
-            rc = settings_save_one(ADDR_FLASH_DEVNONCE_CONTEXT, (void *) buffer, size);
-            break;
-
-         case CONTEXT_SECURE_ELEMENT:
-            rc = settings_save_one(ADDR_FLASH_SECURE_ELEMENT_CONTEXT, (void *) buffer, size);
-            break;
-
-         default:
-            LOG_ERR("Unknown context: %u", (uint32_t) ctx_type);
-            k_sleep(K_MSEC(200));
-            k_panic();
-            break;
-      }
+   smtc_modem_hal_stop_timer();
+   smtc_modem_hal_disable_modem_irq();
 
-      if (rc != 0)
-      {
-         LOG_ERR("Settings Set Context %u. Error=%d", (uint32_t) ctx_type, rc);
-      }
-      else
-      {
-         LOG_DBG("Context %u stored.", (uint32_t) ctx_type);
-      }
+   // Wait for a running callback: the modem is initialized again after this.
+   k_work_cancel_sync(&halTimerWorkItem, &sync);
+   k_work_cancel_sync(&halDio1WorkItem, &sync);
+
+   if (sx126x_hal_reset(radioContext) != SX126X_HAL_STATUS_OK)
+   {
+      LOG_ERR("Radio reset.");
    }
 }
 
@@ -513,6 +451,7 @@ void smtc_modem_hal_assert_fail(uint8_t *func, uint32_t line)
       "ERROR: Crash log :%s:%u\n"
       "\x1B[0m",  // revert default color
       func, line);
+   SmtcModemHalRecover();
    smtc_modem_hal_reset_mcu();
 }
 
@@ -525,13 +464,18 @@ void smtc_modem_hal_assert_fail(uint8_t *func, uint32_t line)
  */
 uint32_t smtc_modem_hal_get_random_nb(void)
 {
+#if defined(CONFIG_LBM_MODEM_HAL_ENTROPY)
+   return SmtcModemHalEntropyGet();
+#else
    static bool srandInit = false;
    if (!srandInit)
    {
       srand(k_uptime_ticks());
       srandInit = true;
    }
-   return (uint32_t) rand();
+   // rand() gives 31 bits at most.
+   return ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+#endif
 }
 
 /**
@@ -545,14 +489,26 @@ uint32_t smtc_modem_hal_get_random_nb(void)
  */
 uint32_t smtc_modem_hal_get_random_nb_in_range(const uint32_t val_1, const uint32_t val_2)
 {
-   if (val_1 <= val_2)
+   const uint32_t min = MIN(val_1, val_2);
+   const uint32_t range = MAX(val_1, val_2) - min + 1;
+   uint32_t threshold;
+   uint32_t value;
+
+   // Full 32 bits range.
+   if (range == 0)
    {
-      return (uint32_t) ((smtc_modem_hal_get_random_nb() % (val_2 - val_1 + 1)) + val_1);
+      return smtc_modem_hal_get_random_nb();
    }
-   else
+
+   // Reject the values below 2^32 mod range, so each result has the same
+   // number of values: a plain modulo favors the low results.
+   threshold = (0 - range) % range;
+   do
    {
-      return (uint32_t) ((smtc_modem_hal_get_random_nb() % (val_1 - val_2 + 1)) + val_2);
-   }
+      value = smtc_modem_hal_get_random_nb();
+   } while (value < threshold);
+
+   return min + (value % range);
 }
 
 /**
@@ -569,13 +525,13 @@ int32_t smtc_modem_hal_get_signed_random_nb_in_range(const int32_t val_1, const
    uint32_t tmp_range = 0;
    if (val_1 <= val_2)
    {
-      tmp_range = (val_2 - val_1);
-      return (int32_t) ((val_1 + smtc_modem_hal_get_random_nb_in_range(0, tmp_range)));
+      tmp_range = ((uint32_t) val_2 - (uint32_t) val_1);
+      return (int32_t) (((uint32_t) val_1 + smtc_modem_hal_get_random_nb_in_range(0, tmp_range)));
    }
    else
    {
-      tmp_range = (val_1 - val_2);
-      return (int32_t) ((val_2 + smtc_modem_hal_get_random_nb_in_range(0, tmp_range)));
+      tmp_range = ((uint32_t) val_1 - (uint32_t) val_2);
+      return (int32_t) (((uint32_t) val_2 + smtc_modem_hal_get_random_nb_in_range(0, tmp_range)));
    }
 }
 
@@ -592,6 +548,7 @@ void smtc_modem_hal_irq_config_radio_irq(void(*callback)(void *context), void *c
    int rc = 0;
    sx126x_hal_context_t const * const radioContext = modem_context_get_modem_radio_ctx();
 
+   HalWorkQueueInit();
    gpio_init_callback(&halDio1CallbackData, HalDio1Handler, BIT(radioContext->gpioDio1.pin));
    rc = gpio_add_callback(radioContext->gpioDio1.port, &halDio1CallbackData);
    if (rc < 0)
@@ -610,30 +567,9 @@ void smtc_modem_hal_irq_config_radio_irq(void(*callback)(void *context), void *c
  */
 void smtc_modem_hal_radio_irq_clear_pending(void)
 {
-   // Copied from gpio_nrfx.c.
-   struct gpio_nrfx_cfg
-   {
-      struct gpio_driver_config common;
-      NRF_GPIO_Type *port;
-      uint32_t edge_sense;
-      uint8_t port_num;
-   };
-
    sx126x_hal_context_t const * const radioContext = modem_context_get_modem_radio_ctx();
-   uint8_t ch;
-   const struct gpio_nrfx_cfg *gpioCfg = (const struct gpio_nrfx_cfg *) (radioContext->gpioDio1.port->config);
-   uint32_t abs_pin = NRF_GPIO_PIN_MAP(gpioCfg->port_num, radioContext->gpioDio1.pin);
-   nrfx_err_t err = nrfx_gpiote_channel_get(abs_pin, &ch);
-   if (err != NRFX_SUCCESS)
-   {
-      LOG_ERR("GPIOTE channel error: %u", (uint32_t) err);
-   }
-   else
-   {
-      LOG_DBG("Clear IRQ for GPIO Port=%u Pin=%u", gpioCfg->port_num, radioContext->gpioDio1.pin);
 
-      nrf_gpiote_event_clear(NRF_GPIOTE, nrf_gpiote_in_event_get(ch));
-   }
+   SmtcModemHalPlatformIrqClearPending(&radioContext->gpioDio1, halDio1IrqEnabled);
 }
 
 /**
@@ -672,13 +608,14 @@ uint32_t smtc_modem_hal_get_radio_tcxo_startup_delay_ms(void)
 
 /**
  * @brief Return the battery level.
- *    A value between 0 (for 0%) and 255 (for 100%).
+ *    A value between 1 (for 0%) and 254 (for 100%), 255 when not measured yet.
  *
  * @return uint8_t Battery level for lorawan stack.
  */
 uint8_t smtc_modem_hal_get_battery_level(void)
 {
-   uint8_t bat = 254;
+   uint8_t bat = SmtcModemHalSupplyLevel();
+
    LOG_DBG("Battery: %u", bat);
    return bat;
 }
@@ -690,21 +627,20 @@ uint8_t smtc_modem_hal_get_battery_level(void)
  */
 int8_t smtc_modem_hal_get_temperature(void)
 {
-   int8_t tempC;
-   struct sensor_value temperature;
-
-   TemperatureGet(&temperature);
+   const int64_t maxAgeTicks = k_ms_to_ticks_ceil64(CONFIG_LBM_MODEM_HAL_TEMP_MAX_AGE_S * MSEC_PER_SEC);
+   k_spinlock_key_t key = k_spin_lock(&temperatureLock);
+   bool fresh = temperatureValid && (k_uptime_ticks() - temperatureTicks <= maxAgeTicks);
+   int8_t tempC = temperatureC;
 
-   tempC = (int8_t) temperature.val1;
+   k_spin_unlock(&temperatureLock, key);
 
-   // Round up?
-   if (temperature.val2 >= 500000)
+   // First call, or the work is late: sample now, and start the work.
+   if (!fresh)
    {
-      tempC += 1;
+      tempC = TemperatureSample();
+      k_work_schedule(&temperatureWork, K_SECONDS(CONFIG_LBM_MODEM_HAL_TEMP_PERIOD_S));
    }
 
-   LOG_DBG("Temperature: %d C", tempC);
-
    return tempC;
 }
 
@@ -716,7 +652,13 @@ int8_t smtc_modem_hal_get_temperature(void)
  */
 uint8_t smtc_modem_hal_get_voltage(void)
 {
-   uint16_t measure_vref_mv = 3300;
+   uint16_t measure_vref_mv;
+
+   // Nominal supply until the first measurement.
+   if (!SmtcModemHalSupplyGetMv(&measure_vref_mv))
+   {
+      measure_vref_mv = 3300;
+   }
 
    LOG_DBG("Voltage: %u mV", measure_vref_mv);
 
@@ -727,11 +669,12 @@ uint8_t smtc_modem_hal_get_voltage(void)
 /**
  * @brief Return board wake up delay in ms.
  *
- * @return uint8_t Board wake up delay in ms.
+ * @return uint8_t Board wake up delay in ms, calibrated with
+ *         smtc_modem_hal_board_delay_calibrate().
  */
 int8_t smtc_modem_hal_get_board_delay_ms(void)
 {
-   return 1;
+   return SmtcModemHalBoardDelayMs();
 }
 
 /* ------------ Trace management ------------*/
@@ -743,10 +686,12 @@ int8_t smtc_modem_hal_get_board_delay_ms(void)
  */
 void smtc_modem_hal_print_trace(const char *fmt, ...)
 {
+#if defined(CONFIG_LBM_MODEM_HAL_TRACE)
    va_list args;
    va_start(args, fmt);
    log2_generic(LOG_LEVEL_DBG, fmt, args);
    va_end(args);
+#endif
 }
 
 /*
@@ -754,63 +699,6 @@ void smtc_modem_hal_print_trace(const char *fmt, ...)
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
  */
 
-/**
- * @brief Initializes the Settings subsystem, if necessary.
- *
- * @return True if Settings subsystem is initialized.
- */
-static bool InitSettingsSubsys(void)
-{
-
-   if (!settingsSubsysInit)
-   {
-      int rc = settings_subsys_init();
-      if (rc)
-      {
-         LOG_ERR("Settings subsys initialization: %d", rc);
-         k_sleep(K_MSEC(200));
-         k_panic();
-      }
-      else
-      {
-         settingsSubsysInit = true;
-      }
-   }
-   return settingsSubsysInit;
-}
-
-static int DirectLoadHandler(const char *name, size_t len, settings_read_cb read_cb,
-                             void *cb_arg, void *param)
-{
-   const char *next;
-   size_t name_len;
-   int rc;
-   DirectLoadParams_t *directLoadParams = (DirectLoadParams_t *) param;
-
-   name_len = settings_name_next(name, &next);
-
-   if (name_len == 0)
-   {
-      if (len == directLoadParams->len)
-      {
-         rc = read_cb(cb_arg, directLoadParams->dest, len);
-         if (rc >= 0)
-         {
-            directLoadParams->fetched = true;
-            return 0;
-         }
-
-         LOG_ERR("Read CB error: %d", rc);
-         return rc;
-      }
-      return -EINVAL;
-   }
-
-   // Other keys aren't served by the callback.
-   // Return success in order to skip them and keep storage processing.
-   return 0;
-}
-
 /**
  * @brief DIO1 expiration work queue handler.
  *
@@ -818,6 +706,8 @@ static int DirectLoadHandler(const char *name, size_t len, settings_read_cb read
  */
 static void HalDio1WorkHandler(struct k_work *work)
 {
+   SmtcModemHalLatencyRecord(SMTC_MODEM_HAL_LATENCY_DIO1, halDio1IrqCycles);
+
    if (HalDio1Callback != NULL)
    {
       LOG_DBG("DIO1 interrupt. Call handler.");
@@ -835,6 +725,8 @@ static void HalDio1WorkHandler(struct k_work *work)
 static void HalDio1Handler(const struct device *port,
                            struct gpio_callback *dio1CallbackData, uint32_t pins)
 {
+   HalDio1IrqTimeLatch();
+
    if (pins != dio1CallbackData->pin_mask)
    {
       LOG_ERR("DIO1 pin mismatch. Got=0x%02X Expected=0x%02X",
@@ -842,8 +734,14 @@ static void HalDio1Handler(const struct device *port,
    }
    else if (HalDio1Callback != NULL)
    {
-      // Offload the DIO1 handling to a work queue thread.
-      k_work_submit(&halDio1WorkItem);
+      const uint32_t irqCycles = k_cycle_get_32();
+
+      // Offload the DIO1 handling to a work queue thread. Keep the time of the
+      // first interrupt if the work is already queued.
+      if (HalWorkSubmit(&halDio1WorkItem) > 0)
+      {
+         halDio1IrqCycles = irqCycles;
+      }
    }
 }
 
@@ -854,6 +752,8 @@ static void HalDio1Handler(const struct device *port,
  */
 static void HalTimerWorkHandler(struct k_work *work)
 {
+   SmtcModemHalLatencyRecord(SMTC_MODEM_HAL_LATENCY_TIMER, halTimerIrqCycles);
+
    if (HalTimerCallback != NULL)
    {
       LOG_DBG("Timeout. Call handler.");
@@ -876,32 +776,180 @@ static void HalTimerHandler(struct k_timer *timer)
       }
       else if (HalTimerCallback != NULL)
       {
+         const uint32_t irqCycles = k_cycle_get_32();
+
          // Offload the timer handling to a work queue thread.
-         k_work_submit(&halTimerWorkItem);
+         if (HalWorkSubmit(&halTimerWorkItem) > 0)
+         {
+            halTimerIrqCycles = irqCycles;
+         }
       }
    }
 }
 
+/**
+ * @brief Latch the time of a DIO1 interrupt.
+ *
+ * @remark Only called by the DIO1 interrupt handler, the single writer.
+ */
+static void HalDio1IrqTimeLatch(void)
+{
+   // Odd sequence: write in progress. atomic_inc() is a full memory barrier.
+   atomic_inc(&halDio1IrqSequence);
+   halDio1IrqTicks = k_uptime_ticks();
+   atomic_inc(&halDio1IrqSequence);
+}
+
+/**
+ * @brief Get the time of the last DIO1 interrupt.
+ *
+ * @param [out] ticks Uptime of the interrupt, in ticks.
+ *
+ * @return False if there was no DIO1 interrupt yet.
+ */
+static bool HalDio1IrqTimeGet(int64_t *ticks)
+{
+   atomic_val_t sequence;
+
+   do
+   {
+      sequence = atomic_get(&halDio1IrqSequence);
+      *ticks = halDio1IrqTicks;
+   } while (((sequence & 1) != 0) || (atomic_get(&halDio1IrqSequence) != sequence));
+
+   return sequence != 0;
+}
+
+/**
+ * @brief Start the modem work queue thread, if necessary.
+ */
+static void HalWorkQueueInit(void)
+{
+#if defined(CONFIG_LBM_MODEM_HAL_WORKQ)
+   const struct k_work_queue_config halWorkQueueConfig = { .name = "lbm_hal_workq" };
+
+   if (!halWorkQueueInit)
+   {
+      k_work_queue_init(&halWorkQueue);
+      k_work_queue_start(&halWorkQueue, halWorkQueueStack, K_THREAD_STACK_SIZEOF(halWorkQueueStack),
+                         CONFIG_LBM_MODEM_HAL_WORKQ_PRIORITY, &halWorkQueueConfig);
+      halWorkQueueInit = true;
+   }
+#endif
+}
+
+/**
+ * @brief Submit a modem callback work item.
+ *
+ * @remark The work queue thread runs only once the interrupt handler returns, so
+ *         the handler may still update the work data after the submission.
+ *
+ * @param [in] work Work object.
+ *
+ * @return Result of k_work_submit_to_queue(): 1 or 2 if the work was queued,
+ *         0 if it was already queued, a negative error otherwise.
+ */
+static int HalWorkSubmit(struct k_work *work)
+{
+#if defined(CONFIG_LBM_MODEM_HAL_WORKQ)
+   return k_work_submit_to_queue(&halWorkQueue, work);
+#else
+   return k_work_submit(work);
+#endif
+}
+
 #define DEFAULT_TEMPERATURE            25
 
+#if DT_NODE_HAS_STATUS(DT_NODELABEL(temp), okay)
 static const struct device *const device = DEVICE_DT_GET(DT_NODELABEL(temp));
+#endif
+
+/**
+ * @brief Sample the die temperature into the cache.
+ *
+ * @remark On a sensor error the cache isn't refreshed, and the last sample,
+ *         or the default temperature before the first one, is returned.
+ *
+ * @return Temperature, rounded to the nearest degree Celsius.
+ */
+static int8_t TemperatureSample(void)
+{
+   int8_t tempC;
+   struct sensor_value temperature;
+   k_spinlock_key_t key;
+
+   if (!TemperatureGet(&temperature))
+   {
+      key = k_spin_lock(&temperatureLock);
+      tempC = temperatureValid ? temperatureC : DEFAULT_TEMPERATURE;
+      k_spin_unlock(&temperatureLock, key);
+
+      return tempC;
+   }
+
+   tempC = (int8_t) temperature.val1;
+
+   // Round up?
+   if (temperature.val2 >= 500000)
+   {
+      tempC += 1;
+   }
 
-static void TemperatureGet(struct sensor_value *temperature)
+   key = k_spin_lock(&temperatureLock);
+   temperatureC = tempC;
+   temperatureTicks = k_uptime_ticks();
+   temperatureValid = true;
+   k_spin_unlock(&temperatureLock, key);
+
+   LOG_DBG("Temperature: %d C", tempC);
+
+   return tempC;
+}
+
+/**
+ * @brief Periodic temperature sampling work handler.
+ *
+ * @remark Runs on the system work queue, below the modem work queue.
+ *
+ * @param [in] work Work object.
+ */
+static void TemperatureWorkHandler(struct k_work *work)
+{
+   TemperatureSample();
+   k_work_schedule(&temperatureWork, K_SECONDS(CONFIG_LBM_MODEM_HAL_TEMP_PERIOD_S));
+}
+
+/**
+ * @brief Read the die temperature sensor.
+ *
+ * @param [out] temperature Temperature in degrees Celsius, set on success only.
+ *
+ * @return true on success.
+ */
+static bool TemperatureGet(struct sensor_value *temperature)
 {
    struct sensor_value val = {DEFAULT_TEMPERATURE, 0};
 
+#if !DT_NODE_HAS_STATUS(DT_NODELABEL(temp), okay)
+   // No temperature sensor, e.g. native_sim.
+   *temperature = val;
+#else
    int err = sensor_sample_fetch(device);
    if (!err)
    {
       // Get the device die temperature in degrees Celsius.
       err = sensor_channel_get(device, SENSOR_CHAN_DIE_TEMP, &val);
-      if (!err)
-      {
-         *temperature = val;
+   }
 
-         LOG_INF("Device temperature: %d.%06d C", val.val1, val.val2);
-      }
+   if (err)
+   {
+      LOG_WRN("Temperature read failed: %d", err);
+      return false;
    }
 
+   *temperature = val;
+#endif
+
+   return true;
 }
 
@@ -0,0 +1,267 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Calibration of the board delay of the LoRa Basics Modem HAL.
+*
+* @details  The board delay is the time from the MCU issuing a radio command
+*           to the radio running it, by which the modem opens the RX windows
+*           early. It is measured with the radio HAL timestamps, from the sleep
+*           mode: NSS wake-up, SPI transfer and BUSY, as for the command
+*           starting an RX window. The worst measurement is kept, rounded up
+*           to the millisecond, and stored in the settings with the board and
+*           radio SPI configuration it was measured on: a new board or radio
+*           SPI configuration measures again, a rebuild of the same one
+*           doesn't.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+#include "sx126x_hal.h"
+#include "sx126x_hal_context.h"
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_ext.h"
+#include "smtc_modem_hal_internal.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(ModemHALBoardDelay, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define BOARD_DELAY_KEY             "lbm_hal/board_delay_us"
+
+// Measurements of a calibration.
+#define BOARD_DELAY_SAMPLES         8
+
+// SX126X_SET_SLEEP with warm start, and SX126X_SET_STANDBY on the RC oscillator.
+#define OPCODE_SET_SLEEP            0x84
+#define SLEEP_CFG_WARM_START        0x04
+#define OPCODE_SET_STANDBY          0x80
+#define STANDBY_CFG_RC              0x00
+
+// Longest plausible board delay, as returned by SmtcModemHalBoardDelayMs().
+#define BOARD_DELAY_MAX_US          (INT8_MAX * USEC_PER_MSEC)
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+// Stored calibration.
+typedef struct
+{
+   uint32_t    delayUs;             // Board delay
+   uint32_t    configId;            // Board and radio SPI configuration it was measured on
+} BoardDelayRecord_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+// Calibrated board delay, 0 until calibrated.
+static uint32_t               boardDelayUs;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static uint32_t BoardDelayConfigId(const void *radioContext);
+static int BoardDelayMeasureUs(const void *radioContext, uint32_t *delayUs);
+static int BoardDelayLoadHandler(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg, void *param);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Calibrate the board delay, or load the stored calibration.
+ *
+ * @remark The calibration is measured again when none is stored for this board
+ *         and radio SPI configuration. The measurement resets the radio, configuring its GPIOs,
+ *         so it can run before smtc_modem_init().
+ *
+ * @param [in] radio_context Radio implementation parameters.
+ *
+ * @return 0 on success, negative error code otherwise.
+ */
+int smtc_modem_hal_board_delay_calibrate(const void *radio_context)
+{
+   BoardDelayRecord_t stored = {0};
+   BoardDelayRecord_t measured = {.configId = BoardDelayConfigId(radio_context)};
+   int rc = settings_subsys_init();
+
+   if (rc == 0)
+   {
+      rc = settings_load_subtree_direct(BOARD_DELAY_KEY, BoardDelayLoadHandler, &stored);
+   }
+
+   if (rc != 0)
+   {
+      LOG_ERR("Board delay load. Error=%d", rc);
+   }
+
+   if ((stored.delayUs != 0) && (stored.configId == measured.configId))
+   {
+      boardDelayUs = stored.delayUs;
+      LOG_INF("Board delay %u us, %d ms.", boardDelayUs, SmtcModemHalBoardDelayMs());
+      return 0;
+   }
+
+   rc = BoardDelayMeasureUs(radio_context, &measured.delayUs);
+   if (rc != 0)
+   {
+      LOG_ERR("Board delay measurement. Error=%d", rc);
+      return rc;
+   }
+
+   boardDelayUs = measured.delayUs;
+   LOG_INF("Board delay calibrated: %u us, %d ms.", boardDelayUs, SmtcModemHalBoardDelayMs());
+
+   rc = settings_save_one(BOARD_DELAY_KEY, &measured, sizeof(measured));
+   if (rc != 0)
+   {
+      LOG_ERR("Board delay save. Error=%d", rc);
+   }
+
+   return rc;
+}
+
+/**
+ * @brief Get the board delay.
+ *
+ * @return Calibrated board delay, rounded up to the millisecond, or the
+ *         default board delay until calibrated.
+ */
+int8_t SmtcModemHalBoardDelayMs(void)
+{
+   if (boardDelayUs == 0)
+   {
+      return CONFIG_LBM_MODEM_HAL_BOARD_DELAY_MS;
+   }
+
+   return (int8_t) MIN(DIV_ROUND_UP(boardDelayUs, USEC_PER_MSEC), INT8_MAX);
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Identify the board and radio SPI configuration a calibration is measured on.
+ *
+ * @remark Doesn't depend on the build, so that a rebuild keeps the calibration.
+ *
+ * @param [in] radioContext Radio implementation parameters.
+ *
+ * @return CRC of the board name, radio SPI clock and SPI operation.
+ */
+static uint32_t BoardDelayConfigId(const void *radioContext)
+{
+   const sx126x_hal_context_t *sx126xContext = (const sx126x_hal_context_t *) radioContext;
+   static const char board[] = CONFIG_BOARD;
+   const uint32_t spi[] = {sx126xContext->spiSpec.config.frequency, sx126xContext->spiSpec.config.operation};
+
+   return crc32_ieee_update(crc32_ieee((const uint8_t *) board, sizeof(board)), (const uint8_t *) spi, sizeof(spi));
+}
+
+/**
+ * @brief Measure the board delay.
+ *
+ * @remark The radio is reset first, and left in sleep mode.
+ *
+ * @param [in]  radioContext Radio implementation parameters.
+ * @param [out] delayUs      Longest measured delay.
+ *
+ * @return 0 on success, -EIO on a radio error, -ERANGE on an implausible delay.
+ */
+static int BoardDelayMeasureUs(const void *radioContext, uint32_t *delayUs)
+{
+   const uint8_t sleepCommand[] = {OPCODE_SET_SLEEP, SLEEP_CFG_WARM_START};
+   const uint8_t standbyCommand[] = {OPCODE_SET_STANDBY, STANDBY_CFG_RC};
+   uint32_t maxUs = 0;
+
+   // Configures the radio GPIOs, and starts from a known radio state.
+   if (sx126x_hal_reset(radioContext) != SX126X_HAL_STATUS_OK)
+   {
+      return -EIO;
+   }
+
+   for (uint32_t i = 0; i < BOARD_DELAY_SAMPLES; i++)
+   {
+      uint32_t startCycles;
+      uint32_t sampleUs;
+
+      if (sx126x_hal_write(radioContext, sleepCommand, sizeof(sleepCommand), NULL, 0) != SX126X_HAL_STATUS_OK)
+      {
+         return -EIO;
+      }
+
+      // Let the radio settle in sleep mode.
+      k_sleep(K_MSEC(1));
+
+      // Wake-up, command, then BUSY until the radio runs it.
+      startCycles = k_cycle_get_32();
+      if ((sx126x_hal_write(radioContext, standbyCommand, sizeof(standbyCommand), NULL, 0) != SX126X_HAL_STATUS_OK) ||
+          (sx126x_hal_wakeup(radioContext) != SX126X_HAL_STATUS_OK))
+      {
+         return -EIO;
+      }
+      sampleUs = k_cyc_to_us_ceil32(k_cycle_get_32() - startCycles);
+
+      LOG_DBG("Board delay sample %u: %u us.", i, sampleUs);
+      maxUs = MAX(maxUs, sampleUs);
+   }
+
+   if (sx126x_hal_write(radioContext, sleepCommand, sizeof(sleepCommand), NULL, 0) != SX126X_HAL_STATUS_OK)
+   {
+      return -EIO;
+   }
+
+   if (maxUs > BOARD_DELAY_MAX_US)
+   {
+      return -ERANGE;
+   }
+
+   *delayUs = MAX(maxUs, 1);
+   return 0;
+}
+
+/**
+ * @brief Settings handler loading the stored board delay.
+ */
+static int BoardDelayLoadHandler(const char *name, size_t len, settings_read_cb read_cb,
+                                 void *cb_arg, void *param)
+{
+   const char *next;
+   int rc;
+
+   // A calibration of an older format is ignored, and measured again.
+   if ((settings_name_next(name, &next) != 0) || (len != sizeof(BoardDelayRecord_t)))
+   {
+      return 0;
+   }
+
+   rc = read_cb(cb_arg, param, len);
+   return (rc < 0) ? rc : 0;
+}
@@ -0,0 +1,868 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Storage of the LoRa Basics Modem contexts in the settings.
+*
+* @details  Each context has a RAM mirror of its last stored value. A store
+*           identical to the mirror is skipped. A context with the deferred
+*           durability policy is only copied to the mirror, and written to
+*           flash by a delayed flush, so that successive stores are coalesced.
+*           A context with the immediate policy is written through.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_ext.h"
+#include "smtc_modem_hal_internal.h"
+#include "modem_context.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(ModemHALContext, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define SETTINGS_SUBTREE_NAME                "lbm_context"
+#define ADDR_FLASH_MODEM_CONTEXT             SETTINGS_SUBTREE_NAME "/modem"
+#define ADDR_FLASH_LR1MAC_CONTEXT            SETTINGS_SUBTREE_NAME "/lr1mac"
+#define ADDR_FLASH_DEVNONCE_CONTEXT          SETTINGS_SUBTREE_NAME "/devnonce"
+#define ADDR_FLASH_SECURE_ELEMENT_CONTEXT    SETTINGS_SUBTREE_NAME "/secure_element"
+
+#define CONTEXT_RETAINED_MAGIC               0x5243424C     // "LBCR"
+
+// Key of a context relative to the subtree.
+#define CONTEXT_NAME(key)                    (&(key)[sizeof(SETTINGS_SUBTREE_NAME)])
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct DirectLoadParams_s
+{
+   size_t   len;
+   void     *dest;
+   bool     fetched;
+} DirectLoadParams_t;
+
+// A context and its RAM mirror.
+typedef struct ContextEntry_s
+{
+   const char  *key;                // Settings key
+   bool        deferred;            // Durability policy: flushed later, or written through
+   bool        journal;             // Stored in the journal rather than the settings
+   bool        valid;               // The mirror holds the last stored value
+   bool        dirty;               // The mirror isn't written to flash yet
+   bool        unmirrored;          // Stored context too large for the mirror
+   uint32_t    size;
+   uint8_t     data[CONFIG_LBM_MODEM_HAL_CONTEXT_MAX_SIZE];
+} ContextEntry_t;
+
+// Copy of a context kept in RAM across warm resets.
+typedef struct ContextRetained_s
+{
+   uint32_t    magic;
+   uint32_t    key;                 // Build layout of the image that wrote it
+   uint32_t    size;
+   uint32_t    dirty;               // Not written to flash before the reset
+   uint8_t     data[CONFIG_LBM_MODEM_HAL_CONTEXT_MAX_SIZE];
+   uint32_t    crc;                 // CRC of the fields above, data up to size
+} ContextRetained_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static bool                   settingsSubsysInit = false;
+static bool                   contextsPreloaded = false;
+static bool                   contextsRetainedChecked = false;
+
+static ContextEntry_t         contexts[] = {
+   [CONTEXT_MODEM] = {
+      .key = ADDR_FLASH_MODEM_CONTEXT,
+      .deferred = IS_ENABLED(CONFIG_LBM_MODEM_HAL_CONTEXT_MODEM_DEFERRED),
+      .journal = IS_ENABLED(CONFIG_LBM_MODEM_HAL_CONTEXT_MODEM_JOURNAL),
+   },
+   [CONTEXT_LR1MAC] = {
+      .key = ADDR_FLASH_LR1MAC_CONTEXT,
+      .deferred = IS_ENABLED(CONFIG_LBM_MODEM_HAL_CONTEXT_LR1MAC_DEFERRED),
+      .journal = IS_ENABLED(CONFIG_LBM_MODEM_HAL_CONTEXT_LR1MAC_JOURNAL),
+   },
+   [CONTEXT_DEVNONCE] = {
+      .key = ADDR_FLASH_DEVNONCE_CONTEXT,
+      .deferred = IS_ENABLED(CONFIG_LBM_MODEM_HAL_CONTEXT_DEVNONCE_DEFERRED),
+      .journal = IS_ENABLED(CONFIG_LBM_MODEM_HAL_CONTEXT_DEVNONCE_JOURNAL),
+   },
+   [CONTEXT_SECURE_ELEMENT] = {
+      .key = ADDR_FLASH_SECURE_ELEMENT_CONTEXT,
+      .deferred = IS_ENABLED(CONFIG_LBM_MODEM_HAL_CONTEXT_SECURE_ELEMENT_DEFERRED),
+      .journal = IS_ENABLED(CONFIG_LBM_MODEM_HAL_CONTEXT_SECURE_ELEMENT_JOURNAL),
+   },
+};
+
+#if defined(CONFIG_LBM_MODEM_HAL_CONTEXT_RETAINED)
+static ContextRetained_t __attribute__((section(".noinit"))) retainedContexts[ARRAY_SIZE(contexts)];
+#endif
+
+// Protects the mirrors, used by the modem thread and the flush work.
+static K_MUTEX_DEFINE(contextLock);
+
+static smtc_modem_hal_context_stats_t contextStats;
+
+#if defined(CONFIG_LBM_MODEM_HAL_FLASH_SCHED)
+// End of the radio idle time reported by the application.
+static int64_t                flashIdleEndTicks;
+
+// Time by which the dirty contexts are written, 0 if none.
+static int64_t                flashDeadlineTicks;
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static ContextEntry_t *ContextEntry(const modem_context_type_t ctx_type);
+static int ContextWrite(ContextEntry_t *entry, const uint8_t *buffer, const uint32_t size);
+static void ContextFlush(void);
+static void ContextFlushSchedule(void);
+static void ContextFlushWorkHandler(struct k_work *work);
+static void ContextPreload(void);
+static void ContextJournalLoad(ContextEntry_t *entry);
+static void ContextRetainedLoad(void);
+static void ContextRetainedSave(ContextEntry_t *entry);
+#if defined(CONFIG_LBM_MODEM_HAL_CONTEXT_RETAINED)
+static uint32_t ContextRetainedKey(void);
+static uint32_t ContextRetainedCrc(const ContextRetained_t *retained);
+#endif
+static int PreloadHandler(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg, void *param);
+static bool InitSettingsSubsys(void);
+static int DirectLoadHandler(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg, void *param);
+
+static K_WORK_DELAYABLE_DEFINE(contextFlushWork, ContextFlushWorkHandler);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/* ------------ Context saving management ------------*/
+
+/**
+ * @brief Restores the data context.
+ *
+ * @remark This function is used to restore Modem data from a non-volatile memory.
+ *
+ * @param [in] ctx_type   Type of modem context that need to be restored.
+ * @param [out] buffer    Buffer pointer to write to.
+ * @param [in] size       Buffer size to read in bytes.
+ */
+void smtc_modem_hal_context_restore(const modem_context_type_t ctx_type, uint8_t *buffer, const uint32_t size)
+{
+   int rc = 0;
+   DirectLoadParams_t directLoadParams;
+   ContextEntry_t *entry = ContextEntry(ctx_type);
+   uint32_t startCycles;
+
+   k_mutex_lock(&contextLock, K_FOREVER);
+
+   if (!contextsRetainedChecked)
+   {
+      ContextRetainedLoad();
+   }
+
+   if (IS_ENABLED(CONFIG_LBM_MODEM_HAL_CONTEXT_PRELOAD) && !contextsPreloaded)
+   {
+      ContextPreload();
+   }
+   else if (entry->journal && !entry->valid)
+   {
+      ContextJournalLoad(entry);
+   }
+
+   // The mirror is at least as recent as the flash.
+   if (entry->valid && (entry->size == size))
+   {
+      memcpy(buffer, entry->data, size);
+      k_mutex_unlock(&contextLock);
+      LOG_DBG("Context %u restored from RAM.", (uint32_t) ctx_type);
+      return;
+   }
+
+   // The preload has read all the contexts that fit the mirrors: none stored.
+   if (contextsPreloaded && !entry->unmirrored && !entry->valid)
+   {
+      k_mutex_unlock(&contextLock);
+      return;
+   }
+
+   if (entry->valid)
+   {
+      LOG_WRN("Context %u of %u bytes in RAM, %u requested: read from flash.", (uint32_t) ctx_type,
+              entry->size, size);
+   }
+
+   directLoadParams.fetched = false;
+   directLoadParams.len = size;
+   directLoadParams.dest = buffer;
+
+   if (InitSettingsSubsys())
+   {
+      startCycles = k_cycle_get_32();
+      rc = settings_load_subtree_direct(entry->key, DirectLoadHandler, (void *) &directLoadParams);
+      contextStats.loadScans++;
+      contextStats.loadUs += k_cyc_to_us_floor32(k_cycle_get_32() - startCycles);
+
+      if (rc != 0)
+      {
+         LOG_ERR("Settings Get Context %u. Error=%d", (uint32_t) ctx_type, rc);
+      }
+      else if (!directLoadParams.fetched)
+      {
+         rc = -ENOENT;
+      }
+      else
+      {
+         LOG_DBG("Context %u restored.", (uint32_t) ctx_type);
+
+         // Keep the flash value, so storing it back is skipped.
+         if (size <= sizeof(entry->data))
+         {
+            memcpy(entry->data, buffer, size);
+            entry->size = size;
+            entry->valid = true;
+            entry->dirty = false;
+            ContextRetainedSave(entry);
+         }
+      }
+   }
+
+   k_mutex_unlock(&contextLock);
+}
+
+/**
+ * @brief Stores the data context.
+ *
+ * @remark This function is used to store Modem data in a non-volatile memory.
+ *
+ * @param [in] ctx_type   Type of modem context that need to be saved.
+ * @param [in] buffer     Buffer pointer to write from.
+ * @param [in] size       Buffer size to write in bytes.
+ */
+void smtc_modem_hal_context_store(const modem_context_type_t ctx_type, const uint8_t *buffer, const uint32_t size)
+{
+   int rc = 0;
+   ContextEntry_t *entry = ContextEntry(ctx_type);
+
+   k_mutex_lock(&contextLock, K_FOREVER);
+
+   if (entry->valid && (entry->size == size) && (memcmp(entry->data, buffer, size) == 0))
+   {
+      contextStats.writesSkipped++;
+      LOG_DBG("Context %u unchanged.", (uint32_t) ctx_type);
+   }
+   else if (size > sizeof(entry->data))
+   {
+      // Too large to be mirrored: always written through, and the mirror is
+      // stale.
+      entry->unmirrored = true;
+      entry->valid = false;
+      entry->dirty = false;
+      rc = ContextWrite(entry, buffer, size);
+   }
+   else
+   {
+      memcpy(entry->data, buffer, size);
+      entry->size = size;
+      entry->valid = true;
+
+      if (entry->deferred)
+      {
+         entry->dirty = true;
+         contextStats.writesDeferred++;
+         ContextFlushSchedule();
+      }
+      else
+      {
+         rc = ContextWrite(entry, buffer, size);
+      }
+   }
+
+   ContextRetainedSave(entry);
+
+   k_mutex_unlock(&contextLock);
+
+   if (rc != 0)
+   {
+      LOG_ERR("Settings Set Context %u. Error=%d", (uint32_t) ctx_type, rc);
+   }
+}
+
+/**
+ * @brief Write the deferred contexts to flash now.
+ */
+void smtc_modem_hal_context_flush(void)
+{
+   k_mutex_lock(&contextLock, K_FOREVER);
+   ContextFlush();
+   k_mutex_unlock(&contextLock);
+}
+
+#if defined(CONFIG_LBM_MODEM_HAL_FLASH_SCHED)
+/**
+ * @brief Report a radio idle time, in which the deferred flash writes can run.
+ *
+ * @param [in] idle_ms Time until the next modem task.
+ */
+void smtc_modem_hal_flash_idle(const uint32_t idle_ms)
+{
+   bool pending = false;
+
+   if ((idle_ms < CONFIG_LBM_MODEM_HAL_FLASH_SCHED_MIN_GAP_MS) || !SmtcModemHalRadioIdle())
+   {
+      return;
+   }
+
+   k_mutex_lock(&contextLock, K_FOREVER);
+
+   flashIdleEndTicks = k_uptime_ticks() + k_ms_to_ticks_floor64(idle_ms);
+
+   for (uint32_t i = 0; i < ARRAY_SIZE(contexts); i++)
+   {
+      pending |= contexts[i].dirty;
+   }
+   pending |= SmtcModemHalJournalCompactDue();
+
+   k_mutex_unlock(&contextLock);
+
+   if (pending)
+   {
+      k_work_reschedule(&contextFlushWork, K_NO_WAIT);
+   }
+}
+#endif
+
+/**
+ * @brief Get the context storage counters.
+ *
+ * @param [out] stats Counters since boot.
+ */
+void smtc_modem_hal_context_stats_get(smtc_modem_hal_context_stats_t *stats)
+{
+   k_mutex_lock(&contextLock, K_FOREVER);
+   *stats = contextStats;
+   stats->journalCompactions = SmtcModemHalJournalCompactions();
+   k_mutex_unlock(&contextLock);
+}
+
+/**
+ * @brief Check if the current thread holds the context lock.
+ *
+ * @return true while a context is being read or written.
+ */
+bool SmtcModemHalContextLocked(void)
+{
+   return contextLock.owner == k_current_get();
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Get the entry of a context.
+ *
+ * @remark Panics on an unknown context, as the LBM can't run without storage.
+ */
+static ContextEntry_t *ContextEntry(const modem_context_type_t ctx_type)
+{
+   if (((uint32_t) ctx_type >= ARRAY_SIZE(contexts)) || (contexts[ctx_type].key == NULL))
+   {
+      LOG_ERR("Unknown context: %u", (uint32_t) ctx_type);
+      k_sleep(K_MSEC(200));
+      k_panic();
+   }
+
+   return &contexts[ctx_type];
+}
+
+/**
+ * @brief Load the stored contexts not yet in their mirrors, in one scan of the
+ *        settings storage.
+ *
+ * @remark Called with the context lock held.
+ */
+static void ContextPreload(void)
+{
+   int rc = -EIO;
+   uint32_t missing = 0;
+   uint32_t startCycles;
+   uint32_t elapsedUs;
+
+   // The journal is more recent than the settings, which only hold the
+   // contexts stored before the journal was enabled.
+   for (uint32_t i = 0; i < ARRAY_SIZE(contexts); i++)
+   {
+      if (contexts[i].journal && !contexts[i].valid)
+      {
+         ContextJournalLoad(&contexts[i]);
+      }
+
+      if (!contexts[i].valid)
+      {
+         missing++;
+      }
+   }
+
+   // All restored from the retained RAM or the journal.
+   if (missing == 0)
+   {
+      contextsPreloaded = true;
+      return;
+   }
+
+   // A scan costs the same for one key as for the subtree: the handler reads
+   // only the missing contexts.
+   if (InitSettingsSubsys())
+   {
+      startCycles = k_cycle_get_32();
+      rc = settings_load_subtree_direct(SETTINGS_SUBTREE_NAME, PreloadHandler, NULL);
+      elapsedUs = k_cyc_to_us_floor32(k_cycle_get_32() - startCycles);
+
+      contextStats.loadScans++;
+      contextStats.loadUs += elapsedUs;
+      LOG_INF("Contexts loaded in %u us.", elapsedUs);
+   }
+
+   if (rc != 0)
+   {
+      // Each context not in RAM is then read on its own restore.
+      LOG_ERR("Settings Load Contexts. Error=%d", rc);
+      for (uint32_t i = 0; i < ARRAY_SIZE(contexts); i++)
+      {
+         contexts[i].unmirrored = !contexts[i].valid;
+      }
+   }
+
+   for (uint32_t i = 0; i < ARRAY_SIZE(contexts); i++)
+   {
+      ContextRetainedSave(&contexts[i]);
+   }
+
+   contextsPreloaded = true;
+}
+
+/**
+ * @brief Load a context from the journal into its mirror.
+ *
+ * @remark Called with the context lock held.
+ */
+static void ContextJournalLoad(ContextEntry_t *entry)
+{
+   int rc = SmtcModemHalJournalRead(entry - contexts, entry->data, sizeof(entry->data));
+
+   if (rc > 0)
+   {
+      entry->size = rc;
+      entry->valid = true;
+      entry->dirty = false;
+      ContextRetainedSave(entry);
+   }
+   else if (rc != -ENOENT)
+   {
+      LOG_ERR("Journal Get Context %s. Error=%d", entry->key, rc);
+   }
+}
+
+/**
+ * @brief Load the contexts retained in RAM across a warm reset into their
+ *        mirrors, once.
+ *
+ * @remark Called with the context lock held. The retained copy is at least as
+ *         recent as the flash: it's updated on each store.
+ */
+static void ContextRetainedLoad(void)
+{
+#if defined(CONFIG_LBM_MODEM_HAL_CONTEXT_RETAINED)
+   const uint32_t key = ContextRetainedKey();
+   uint32_t restored = 0;
+
+   for (uint32_t i = 0; i < ARRAY_SIZE(contexts); i++)
+   {
+      ContextEntry_t *entry = &contexts[i];
+      const ContextRetained_t *retained = &retainedContexts[i];
+
+      // Not initialized after a power-on reset, or left by another image.
+      if ((entry->key == NULL) || (retained->magic != CONTEXT_RETAINED_MAGIC) || (retained->key != key) ||
+          (retained->size > sizeof(retained->data)) || (ContextRetainedCrc(retained) != retained->crc))
+      {
+         continue;
+      }
+
+      memcpy(entry->data, retained->data, retained->size);
+      entry->size = retained->size;
+      entry->valid = true;
+      entry->dirty = (retained->dirty != 0);
+      restored++;
+
+      if (entry->dirty)
+      {
+         ContextFlushSchedule();
+      }
+   }
+
+   contextStats.retainedRestores += restored;
+   if (restored > 0)
+   {
+      LOG_INF("%u contexts restored from retained RAM.", restored);
+   }
+#endif
+
+   contextsRetainedChecked = true;
+}
+
+/**
+ * @brief Update the retained copy of a context from its mirror.
+ *
+ * @remark Called with the context lock held.
+ */
+static void ContextRetainedSave(ContextEntry_t *entry)
+{
+#if defined(CONFIG_LBM_MODEM_HAL_CONTEXT_RETAINED)
+   ContextRetained_t *retained = &retainedContexts[entry - contexts];
+
+   if (!entry->valid)
+   {
+      retained->magic = 0;
+      return;
+   }
+
+   retained->magic = CONTEXT_RETAINED_MAGIC;
+   retained->key = ContextRetainedKey();
+   retained->size = entry->size;
+   retained->dirty = entry->dirty;
+   memcpy(retained->data, entry->data, entry->size);
+   retained->crc = ContextRetainedCrc(retained);
+#endif
+}
+
+#if defined(CONFIG_LBM_MODEM_HAL_CONTEXT_RETAINED)
+/**
+ * @brief Identify the layout of the retained contexts in this image.
+ *
+ * @remark A reflash or an update keeping the .noinit section in place still
+ *         finds the copies of the previous image: they are only used if this
+ *         key, and so the layout and image version, didn't change.
+ *
+ * @return CRC of the record layout, the section address, the board and the
+ *         signed image version.
+ */
+static uint32_t ContextRetainedKey(void)
+{
+   static const char build[] = CONFIG_BOARD
+#if defined(CONFIG_MCUBOOT_IMGTOOL_SIGN_VERSION)
+      " " CONFIG_MCUBOOT_IMGTOOL_SIGN_VERSION
+#endif
+      ;
+   static uint32_t key;
+
+   if (key == 0)
+   {
+      const uint32_t layout[] = {sizeof(ContextRetained_t), ARRAY_SIZE(retainedContexts),
+                                 (uint32_t) (uintptr_t) retainedContexts};
+
+      key = crc32_ieee((const uint8_t *) layout, sizeof(layout));
+      key = crc32_ieee_update(key, (const uint8_t *) build, sizeof(build));
+   }
+
+   return key;
+}
+
+static uint32_t ContextRetainedCrc(const ContextRetained_t *retained)
+{
+   uint32_t crc = crc32_ieee((const uint8_t *) retained, offsetof(ContextRetained_t, data));
+
+   return crc32_ieee_update(crc, retained->data, retained->size);
+}
+#endif
+
+/**
+ * @brief Settings load handler of the context preload.
+ */
+static int PreloadHandler(const char *name, size_t len, settings_read_cb read_cb,
+                          void *cb_arg, void *param)
+{
+   const char *next;
+   int rc;
+
+   for (uint32_t i = 0; i < ARRAY_SIZE(contexts); i++)
+   {
+      ContextEntry_t *entry = &contexts[i];
+
+      if ((entry->key == NULL) || !settings_name_steq(name, CONTEXT_NAME(entry->key), &next) ||
+          (next != NULL))
+      {
+         continue;
+      }
+
+      // Already stored since boot: the mirror is more recent.
+      if (entry->valid)
+      {
+         return 0;
+      }
+
+      if (len > sizeof(entry->data))
+      {
+         entry->unmirrored = true;
+         return 0;
+      }
+
+      rc = read_cb(cb_arg, entry->data, len);
+      if (rc < 0)
+      {
+         LOG_ERR("Read CB error: %d", rc);
+         entry->unmirrored = true;
+         return 0;
+      }
+
+      entry->size = len;
+      entry->valid = true;
+      entry->dirty = false;
+      return 0;
+   }
+
+   // Other keys aren't contexts.
+   return 0;
+}
+
+/**
+ * @brief Write a context to flash.
+ *
+ * @remark Called with the context lock held.
+ *
+ * @return 0 on success, a settings or journal error otherwise.
+ */
+static int ContextWrite(ContextEntry_t *entry, const uint8_t *buffer, const uint32_t size)
+{
+   int rc = -EIO;
+
+   if (entry->journal)
+   {
+      rc = SmtcModemHalJournalWrite(entry - contexts, buffer, size);
+      if (rc >= 0)
+      {
+         contextStats.journalBytes += rc;
+         rc = 0;
+      }
+   }
+   else if (InitSettingsSubsys())
+   {
+      rc = settings_save_one(entry->key, buffer, size);
+   }
+
+   if (rc == 0)
+   {
+      entry->dirty = false;
+      contextStats.writesIssued++;
+      contextStats.bytesStored += size;
+      LOG_DBG("Context %s stored.", entry->key);
+   }
+   else
+   {
+      contextStats.writesFailed++;
+
+      // The flash doesn't hold the mirror value: don't skip the next store.
+      if (entry->valid && (buffer != entry->data))
+      {
+         entry->valid = false;
+      }
+   }
+
+   return rc;
+}
+
+/**
+ * @brief Write the deferred contexts to flash.
+ *
+ * @remark Called with the context lock held.
+ */
+static void ContextFlush(void)
+{
+#if defined(CONFIG_LBM_MODEM_HAL_FLASH_SCHED)
+   flashDeadlineTicks = 0;
+#endif
+
+   for (uint32_t i = 0; i < ARRAY_SIZE(contexts); i++)
+   {
+      ContextEntry_t *entry = &contexts[i];
+
+      if (entry->dirty)
+      {
+         int rc = ContextWrite(entry, entry->data, entry->size);
+
+         if (rc != 0)
+         {
+            // Still dirty: written again on the next flush.
+            LOG_ERR("Settings Flush Context %u. Error=%d", i, rc);
+            ContextFlushSchedule();
+         }
+         ContextRetainedSave(entry);
+      }
+   }
+}
+
+/**
+ * @brief Schedule the flush of the dirty contexts, unless already scheduled.
+ *
+ * @remark Called with the context lock held. The deadline is set by the first
+ *         dirty context, the following stores don't postpone it.
+ */
+static void ContextFlushSchedule(void)
+{
+#if defined(CONFIG_LBM_MODEM_HAL_FLASH_SCHED)
+   if (flashDeadlineTicks == 0)
+   {
+      flashDeadlineTicks = k_uptime_ticks() + k_ms_to_ticks_ceil64(CONFIG_LBM_MODEM_HAL_CONTEXT_FLUSH_DELAY_MS);
+   }
+#endif
+
+   k_work_schedule(&contextFlushWork, K_MSEC(CONFIG_LBM_MODEM_HAL_CONTEXT_FLUSH_DELAY_MS));
+}
+
+/**
+ * @brief Deferred context flush work handler.
+ *
+ * @param [in] work Work object.
+ */
+static void ContextFlushWorkHandler(struct k_work *work)
+{
+#if defined(CONFIG_LBM_MODEM_HAL_FLASH_SCHED)
+   const int64_t minGapTicks = k_ms_to_ticks_ceil64(CONFIG_LBM_MODEM_HAL_FLASH_SCHED_MIN_GAP_MS);
+   int64_t nowTicks;
+   int rc;
+
+   k_mutex_lock(&contextLock, K_FOREVER);
+
+   nowTicks = k_uptime_ticks();
+   if ((nowTicks + minGapTicks <= flashIdleEndTicks) && SmtcModemHalRadioIdle())
+   {
+      ContextFlush();
+
+      rc = SmtcModemHalJournalCompact();
+      if (rc > 0)
+      {
+         contextStats.journalBytes += rc;
+      }
+      else if (rc < 0)
+      {
+         LOG_ERR("Journal compaction. Error=%d", rc);
+      }
+
+      contextStats.idleFlushes++;
+      if (k_uptime_ticks() > flashIdleEndTicks)
+      {
+         contextStats.idleOverruns++;
+         LOG_WRN("Flash writes overran the radio idle time.");
+      }
+   }
+   else if (flashDeadlineTicks == 0)
+   {
+      // Only the journal compaction is due: it waits for the next idle time.
+   }
+   else if (nowTicks < flashDeadlineTicks)
+   {
+      // The radio woke up before this ran: wait for the next idle time, or
+      // the deadline.
+      k_work_reschedule(&contextFlushWork, K_TICKS(flashDeadlineTicks - nowTicks));
+   }
+   else
+   {
+      // No idle time before the deadline: write anyway.
+      contextStats.missedDeadlines++;
+      LOG_WRN("No radio idle time to write the contexts.");
+      ContextFlush();
+   }
+
+   k_mutex_unlock(&contextLock);
+#else
+   smtc_modem_hal_context_flush();
+#endif
+}
+
+/**
+ * @brief Initializes the Settings subsystem, if necessary.
+ *
+ * @return True if Settings subsystem is initialized.
+ */
+static bool InitSettingsSubsys(void)
+{
+
+   if (!settingsSubsysInit)
+   {
+      int rc = settings_subsys_init();
+      if (rc)
+      {
+         LOG_ERR("Settings subsys initialization: %d", rc);
+         k_sleep(K_MSEC(200));
+         k_panic();
+      }
+      else
+      {
+         settingsSubsysInit = true;
+      }
+   }
+   return settingsSubsysInit;
+}
+
+static int DirectLoadHandler(const char *name, size_t len, settings_read_cb read_cb,
+                             void *cb_arg, void *param)
+{
+   const char *next;
+   size_t name_len;
+   int rc;
+   DirectLoadParams_t *directLoadParams = (DirectLoadParams_t *) param;
+
+   name_len = settings_name_next(name, &next);
+
+   if (name_len == 0)
+   {
+      if (len == directLoadParams->len)
+      {
+         rc = read_cb(cb_arg, directLoadParams->dest, len);
+         if (rc >= 0)
+         {
+            directLoadParams->fetched = true;
+            return 0;
+         }
+
+         LOG_ERR("Read CB error: %d", rc);
+         return rc;
+      }
+      return -EINVAL;
+   }
+
+   // Other keys aren't served by the callback.
+   // Return success in order to skip them and keep storage processing.
+   return 0;
+}
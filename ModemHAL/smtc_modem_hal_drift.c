@@ -0,0 +1,279 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Low-frequency clock drift estimation and compensation.
+*
+* @details  Each network time synchronization gives the true elapsed time since
+*           the previous one, to compare with the local uptime. The drift is
+*           split into a base error, smoothed over the synchronizations, and
+*           the parabolic temperature dependency of a 32 kHz tuning fork
+*           crystal around its turnover temperature:
+*
+*              drift(T) = base - k * (T - T0)^2
+*
+*           The compensation is the integral of -drift over the local time, so
+*           it changes continuously and never jumps back.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_ext.h"
+#include "smtc_modem_hal_internal.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(ModemHALDrift, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define PPB_PER_UNIT                1000000000LL
+
+// Weight of a new measurement in the smoothed base drift, as a power of 2.
+#define DRIFT_SMOOTHING_SHIFT       2
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct DriftState_s
+{
+   // Last synchronization: network and local time.
+   bool        synced;
+   int64_t     syncNetworkMs;
+   int64_t     syncLocalMs;
+   int8_t      syncTemperature;
+
+   // Smoothed base drift, without the temperature term, and residual error.
+   uint32_t    estimates;
+   int32_t     basePpb;
+   uint32_t    residualPpm;
+
+   // Compensation integrated up to the local time, with the drift at the last
+   // temperature. In ps, i.e. ms x ppb, so short steps are not rounded off.
+   int64_t     compensationPs;
+   int64_t     integratedLocalMs;
+   int8_t      temperature;
+   int64_t     temperatureLocalMs;
+} DriftState_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static DriftState_t           drift = { .residualPpm = CONFIG_LBM_MODEM_HAL_DRIFT_CRYSTAL_PPM };
+static struct k_spinlock      driftLock;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static int32_t DriftTemperaturePpb(int32_t temperature);
+static void DriftIntegrate(int64_t nowMs);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Feed a network time synchronization to the drift estimator.
+ *
+ * @param [in] gps_time_s       Network time, as returned by smtc_modem_get_time().
+ * @param [in] gps_fractional_s Fractional part of the network time, in ms.
+ */
+void smtc_modem_hal_drift_sync(uint32_t gps_time_s, uint32_t gps_fractional_s)
+{
+   const int64_t networkMs = ((int64_t) gps_time_s * 1000) + gps_fractional_s;
+   const int8_t temperature = smtc_modem_hal_get_temperature();
+   const int64_t localMs = k_uptime_get();
+   k_spinlock_key_t key = k_spin_lock(&driftLock);
+
+   DriftIntegrate(localMs);
+
+   if (drift.synced)
+   {
+      const int64_t networkElapsedMs = networkMs - drift.syncNetworkMs;
+      const int64_t localElapsedMs = localMs - drift.syncLocalMs;
+
+      if (networkElapsedMs < (CONFIG_LBM_MODEM_HAL_DRIFT_MIN_INTERVAL_S * 1000LL))
+      {
+         // Too short to measure the drift: keep the previous reference.
+         k_spin_unlock(&driftLock, key);
+         return;
+      }
+
+      // Measured drift, without the temperature term at the mean temperature.
+      const int32_t measuredPpb = (int32_t) (((localElapsedMs - networkElapsedMs) * PPB_PER_UNIT) / networkElapsedMs);
+      const int32_t basePpb = measuredPpb - DriftTemperaturePpb((temperature + drift.syncTemperature) / 2);
+      const int32_t errorPpb = basePpb - drift.basePpb;
+
+      // A network time error of a few tens of ms is tens of ppm over the minimum
+      // interval: drop a drift the crystal can't have, and measure again from
+      // this synchronization.
+      if (abs(basePpb) > (CONFIG_LBM_MODEM_HAL_DRIFT_CRYSTAL_PPM * 1000))
+      {
+         LOG_WRN("Clock drift: measured %d ppb over %u s, beyond the crystal error, dropped", measuredPpb,
+                 (uint32_t) (networkElapsedMs / 1000));
+      }
+      else
+      {
+         if (drift.estimates == 0)
+         {
+            drift.basePpb = basePpb;
+         }
+         else
+         {
+            drift.basePpb += errorPpb / (1 << DRIFT_SMOOTHING_SHIFT);
+            drift.residualPpm = MIN(DIV_ROUND_UP(abs(errorPpb), 1000) + 1, CONFIG_LBM_MODEM_HAL_DRIFT_CRYSTAL_PPM);
+         }
+         drift.estimates++;
+
+         LOG_INF("Clock drift: measured %d ppb over %u s, base %d ppb, residual %u ppm", measuredPpb,
+                 (uint32_t) (networkElapsedMs / 1000), drift.basePpb, drift.residualPpm);
+      }
+   }
+
+   drift.synced = true;
+   drift.syncNetworkMs = networkMs;
+   drift.syncLocalMs = localMs;
+   drift.syncTemperature = temperature;
+   drift.temperature = temperature;
+   drift.temperatureLocalMs = localMs;
+   k_spin_unlock(&driftLock, key);
+}
+
+/**
+ * @brief Get the estimated drift of the local clock.
+ *
+ * @return Drift in ppb, positive if the local clock is fast.
+ */
+int32_t smtc_modem_hal_drift_get_ppb(void)
+{
+   k_spinlock_key_t key = k_spin_lock(&driftLock);
+   const int32_t ppb = (drift.estimates == 0) ? 0 : (drift.basePpb + DriftTemperaturePpb(drift.temperature));
+
+   k_spin_unlock(&driftLock, key);
+   return ppb;
+}
+
+/**
+ * @brief Get the error of the compensated local clock.
+ *
+ * @return Error in ppm, LBM_MODEM_HAL_DRIFT_CRYSTAL_PPM until the drift is known.
+ */
+uint32_t smtc_modem_hal_drift_get_residual_ppm(void)
+{
+   return drift.residualPpm;
+}
+
+/**
+ * @brief Get the error of the local clock used for the modem timings.
+ *
+ * @remark The millisecond and 100 us times aren't compensated: their error is
+ *         the learned drift plus the residual error.
+ *
+ * @return Error in ppm, at most LBM_MODEM_HAL_DRIFT_CRYSTAL_PPM.
+ */
+uint32_t smtc_modem_hal_drift_get_clock_error_ppm(void)
+{
+   k_spinlock_key_t key = k_spin_lock(&driftLock);
+   uint32_t errorPpm = drift.residualPpm;
+
+   if (drift.estimates != 0)
+   {
+      errorPpm += DIV_ROUND_UP(abs(drift.basePpb + DriftTemperaturePpb(drift.temperature)), 1000);
+   }
+   k_spin_unlock(&driftLock, key);
+
+   return MIN(errorPpm, CONFIG_LBM_MODEM_HAL_DRIFT_CRYSTAL_PPM);
+}
+
+/**
+ * @brief Get the time compensation of the local clock drift.
+ *
+ * @return Compensation in seconds, to add to the local time.
+ */
+int32_t SmtcModemHalDriftCompensationS(void)
+{
+   const int64_t nowMs = k_uptime_get();
+   int8_t temperature = drift.temperature;
+   int64_t compensationPs;
+
+   // Refresh the temperature term from time to time, outside of the lock.
+   if (drift.synced && ((nowMs - drift.temperatureLocalMs) >= (CONFIG_LBM_MODEM_HAL_DRIFT_TEMP_PERIOD_S * 1000LL)))
+   {
+      temperature = smtc_modem_hal_get_temperature();
+   }
+
+   k_spinlock_key_t key = k_spin_lock(&driftLock);
+
+   DriftIntegrate(nowMs);
+   if (temperature != drift.temperature)
+   {
+      drift.temperature = temperature;
+      drift.temperatureLocalMs = nowMs;
+   }
+   compensationPs = drift.compensationPs;
+   k_spin_unlock(&driftLock, key);
+
+   return (int32_t) (compensationPs / 1000000000000LL);
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Get the temperature term of the crystal drift.
+ *
+ * @param [in] temperature Temperature in degrees Celsius.
+ *
+ * @return Drift in ppb.
+ */
+static int32_t DriftTemperaturePpb(int32_t temperature)
+{
+   const int32_t delta = temperature - CONFIG_LBM_MODEM_HAL_DRIFT_TURNOVER_C;
+
+   return -(CONFIG_LBM_MODEM_HAL_DRIFT_TEMP_COEFF_PPB * delta * delta);
+}
+
+/**
+ * @brief Integrate the compensation up to the current local time.
+ *
+ * @remark Called with the drift lock held.
+ *
+ * @param [in] nowMs Local time.
+ */
+static void DriftIntegrate(int64_t nowMs)
+{
+   const int64_t elapsedMs = nowMs - drift.integratedLocalMs;
+
+   if (drift.estimates != 0)
+   {
+      const int64_t ppb = drift.basePpb + DriftTemperaturePpb(drift.temperature);
+
+      // A fast clock is ahead of the network time: the compensation is negative.
+      drift.compensationPs -= elapsedMs * ppb;
+   }
+   drift.integratedLocalMs = nowMs;
+}
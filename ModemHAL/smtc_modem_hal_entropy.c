@@ -0,0 +1,181 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Pool of random numbers from the entropy driver.
+*
+* @details  The hardware random generator is slow (about 120 us per word on the
+*           nRF52840 with bias correction), so the random numbers are taken
+*           from a pool, refilled from the system work queue when it's half
+*           empty. A read never waits for the driver: on an empty pool, it
+*           falls back to the non-blocking driver read, then to the random
+*           subsystem.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/entropy.h>
+#include <zephyr/random/random.h>
+#include <zephyr/sys/util.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_ext.h"
+#include "smtc_modem_hal_internal.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(ModemHALEntropy, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define ENTROPY_POOL_WORDS          CONFIG_LBM_MODEM_HAL_ENTROPY_POOL_WORDS
+#define ENTROPY_REFILL_LEVEL        (ENTROPY_POOL_WORDS / 2)
+
+// Words read from the driver at once.
+#define ENTROPY_READ_WORDS          8
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static const struct device *const entropyDevice = DEVICE_DT_GET(DT_CHOSEN(zephyr_entropy));
+static bool                   entropyReady = false;
+
+static uint32_t               entropyPool[ENTROPY_POOL_WORDS];
+static uint32_t               entropyPoolCount;
+static struct k_spinlock      entropyLock;
+
+static smtc_modem_hal_entropy_stats_t entropyStats;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static void EntropyRefillWorkHandler(struct k_work *work);
+static K_WORK_DEFINE(entropyRefillWork, EntropyRefillWorkHandler);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Get the entropy pool counters.
+ *
+ * @param [out] stats Counters since boot.
+ */
+void smtc_modem_hal_entropy_stats_get(smtc_modem_hal_entropy_stats_t *stats)
+{
+   k_spinlock_key_t key = k_spin_lock(&entropyLock);
+
+   *stats = entropyStats;
+   k_spin_unlock(&entropyLock, key);
+}
+
+/**
+ * @brief Get a 32 bits random number.
+ *
+ * @remark Doesn't block, can be called from an interrupt.
+ */
+uint32_t SmtcModemHalEntropyGet(void)
+{
+   uint32_t value = 0;
+   uint32_t count;
+   bool fromPool;
+   k_spinlock_key_t key = k_spin_lock(&entropyLock);
+
+   fromPool = (entropyPoolCount > 0);
+   if (fromPool)
+   {
+      value = entropyPool[--entropyPoolCount];
+      entropyStats.poolWords++;
+   }
+   else
+   {
+      entropyStats.poolMisses++;
+   }
+   count = entropyPoolCount;
+
+   k_spin_unlock(&entropyLock, key);
+
+   if (entropyReady && (count < ENTROPY_REFILL_LEVEL))
+   {
+      k_work_submit(&entropyRefillWork);
+   }
+
+   if (!fromPool && (!entropyReady ||
+       (entropy_get_entropy_isr(entropyDevice, (uint8_t *) &value, sizeof(value), 0) != sizeof(value))))
+   {
+      value = sys_rand32_get();
+   }
+
+   return value;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Entropy pool refill work handler.
+ *
+ * @param [in] work Work object.
+ */
+static void EntropyRefillWorkHandler(struct k_work *work)
+{
+   uint32_t words[ENTROPY_READ_WORDS];
+   bool full = false;
+
+   while (!full)
+   {
+      int rc = entropy_get_entropy(entropyDevice, (uint8_t *) words, sizeof(words));
+
+      if (rc != 0)
+      {
+         LOG_ERR("Entropy read. Error=%d", rc);
+         break;
+      }
+
+      k_spinlock_key_t key = k_spin_lock(&entropyLock);
+
+      for (uint32_t i = 0; (i < ARRAY_SIZE(words)) && (entropyPoolCount < ENTROPY_POOL_WORDS); i++)
+      {
+         entropyPool[entropyPoolCount++] = words[i];
+      }
+      full = (entropyPoolCount == ENTROPY_POOL_WORDS);
+      entropyStats.refills++;
+
+      k_spin_unlock(&entropyLock, key);
+   }
+}
+
+static int EntropyInit(void)
+{
+   if (!device_is_ready(entropyDevice))
+   {
+      LOG_ERR("Entropy device not ready.");
+      return -ENODEV;
+   }
+
+   entropyReady = true;
+   k_work_submit(&entropyRefillWork);
+   return 0;
+}
+
+SYS_INIT(EntropyInit, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
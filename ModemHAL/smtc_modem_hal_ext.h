@@ -0,0 +1,328 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Connected Development extensions of the LoRa Basics Modem HAL.
+*
+* @details  Functions of the modem HAL implementation that are not part of the
+*           Semtech smtc_modem_hal.h interface, for use by the application.
+******************************************************************************/
+
+#ifndef SMTC_MODEM_HAL_EXT_H
+#define SMTC_MODEM_HAL_EXT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <setjmp.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+// Interrupts whose modem callbacks are offloaded to a work queue.
+typedef enum
+{
+   SMTC_MODEM_HAL_LATENCY_TIMER,    // Modem timer expiry
+   SMTC_MODEM_HAL_LATENCY_DIO1,     // Radio DIO1 interrupt
+   SMTC_MODEM_HAL_LATENCY_SOURCES
+} smtc_modem_hal_latency_source_t;
+
+// Dispatch latency, from the interrupt to the start of the modem callback.
+typedef struct
+{
+   uint32_t count;      // Number of callbacks since the last reset
+   uint32_t p50Us;      // Median of the recent samples
+   uint32_t p99Us;      // 99th percentile of the recent samples
+   uint32_t maxUs;      // Maximum since the last reset
+} smtc_modem_hal_latency_t;
+
+// Modem context storage counters, since boot.
+typedef struct
+{
+   uint32_t writesIssued;        // Contexts written to flash
+   uint32_t writesSkipped;       // Stores identical to the stored context
+   uint32_t writesDeferred;      // Stores left to the deferred flush
+   uint32_t writesFailed;        // Writes that failed, retried on the next flush when deferred
+   uint32_t bytesStored;         // Context bytes of the writes issued
+   uint32_t journalBytes;        // Bytes written to the journal flash, records and compactions
+   uint32_t journalCompactions;  // Journal pages filled
+   uint32_t loadScans;           // Scans of the settings storage to restore contexts
+   uint32_t loadUs;              // Time spent in these scans
+   uint32_t retainedRestores;    // Contexts restored from RAM after a warm reset
+   uint32_t idleFlushes;         // Deferred writes run in a radio idle time
+   uint32_t idleOverruns;        // Deferred writes that lasted past the idle time
+   uint32_t missedDeadlines;     // Deferred writes run without a radio idle time
+} smtc_modem_hal_context_stats_t;
+
+// Random number pool counters, since boot.
+typedef struct
+{
+   uint32_t poolWords;           // Random numbers taken from the pool
+   uint32_t poolMisses;          // Random numbers requested while the pool was empty
+   uint32_t refills;             // Reads from the entropy driver
+} smtc_modem_hal_entropy_stats_t;
+
+// In-place recovery counters.
+typedef struct
+{
+   uint32_t recoveries;          // Asserts recovered in place
+   uint32_t lastRecoveryMs;      // Time from the last recovered fault to the first uplink
+   uint32_t lastResetMs;         // Time from the fault before the MCU reset to the first uplink
+} smtc_modem_hal_recovery_stats_t;
+
+// Passes timed by the supervisor.
+typedef enum
+{
+   SMTC_MODEM_HAL_SUPERVISOR_ENGINE,   // smtc_modem_run_engine() call
+   SMTC_MODEM_HAL_SUPERVISOR_EVENT,    // Modem event callback
+   SMTC_MODEM_HAL_SUPERVISOR_SOURCES
+} smtc_modem_hal_supervisor_source_t;
+
+// Supervisor counters of a pass, since boot.
+typedef struct
+{
+   uint32_t count;               // Passes timed
+   uint32_t maxUs;               // Longest pass
+   uint32_t overruns;            // Passes over their budget
+} smtc_modem_hal_supervisor_stats_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+#if defined(CONFIG_LBM_MODEM_HAL_RECOVERY)
+/**
+ * @brief Set the point where the modem thread resumes after an assert.
+ *
+ * @remark To be used as the controlling expression of an if, in the thread
+ *         running the modem engine, before smtc_modem_init(). Evaluates to 0
+ *         when set, to non-zero when resumed after an assert: the modem is
+ *         then stopped and has to be initialized again. The recovery is
+ *         armed by smtc_modem_hal_recovery_init_done(), after
+ *         smtc_modem_init(): an assert in the init resets the MCU.
+ */
+#define SMTC_MODEM_HAL_RECOVERY_POINT() setjmp(*smtc_modem_hal_recovery_arm())
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Write the deferred modem contexts to flash.
+ *
+ * @remark To be called before the power is removed. Called by
+ *         smtc_modem_hal_reset_mcu().
+ */
+void smtc_modem_hal_context_flush(void);
+
+/**
+ * @brief Get the modem context storage counters.
+ *
+ * @param [out] stats Counters since boot.
+ */
+void smtc_modem_hal_context_stats_get(smtc_modem_hal_context_stats_t *stats);
+
+#if defined(CONFIG_LBM_MODEM_HAL_FLASH_SCHED)
+
+/**
+ * @brief Report a radio idle time, in which the deferred flash writes can run.
+ *
+ * @remark To be called with the sleep time returned by smtc_modem_run_engine(),
+ *         before sleeping. The deferred context writes and the journal
+ *         compaction only run in these idle times, or at their deadline.
+ *
+ * @param [in] idle_ms Time until the next modem task.
+ */
+void smtc_modem_hal_flash_idle(const uint32_t idle_ms);
+
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_LATENCY_STATS)
+
+/**
+ * @brief Get the dispatch latency of the callbacks of an interrupt.
+ *
+ * @param [in]  source  Interrupt.
+ * @param [out] latency Dispatch latency.
+ */
+void smtc_modem_hal_latency_get(smtc_modem_hal_latency_source_t source, smtc_modem_hal_latency_t *latency);
+
+/**
+ * @brief Log the dispatch latency of the timer and radio IRQ callbacks.
+ */
+void smtc_modem_hal_latency_log(void);
+
+/**
+ * @brief Clear the dispatch latency samples.
+ */
+void smtc_modem_hal_latency_reset(void);
+
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_DRIFT)
+
+/**
+ * @brief Feed a network time synchronization to the clock drift estimator.
+ *
+ * @remark To be called on each SMTC_MODEM_EVENT_TIME_VALID event.
+ *
+ * @param [in] gps_time_s       Network time, as returned by smtc_modem_get_time().
+ * @param [in] gps_fractional_s Fractional part of the network time, in ms.
+ */
+void smtc_modem_hal_drift_sync(uint32_t gps_time_s, uint32_t gps_fractional_s);
+
+/**
+ * @brief Get the estimated drift of the local clock.
+ *
+ * @return Drift in ppb, positive if the local clock is fast.
+ */
+int32_t smtc_modem_hal_drift_get_ppb(void);
+
+/**
+ * @brief Get the error of the compensated local clock, i.e. of the seconds with
+ *        smtc_modem_hal_get_time_compensation_in_s().
+ *
+ * @return Error in ppm, LBM_MODEM_HAL_DRIFT_CRYSTAL_PPM until the drift is known.
+ */
+uint32_t smtc_modem_hal_drift_get_residual_ppm(void);
+
+/**
+ * @brief Get the error of the uncompensated local clock of the modem timings:
+ *        learned drift plus residual error.
+ *
+ * @remark To be given to smtc_modem_set_crystal_error_ppm(), so the RX windows
+ *         are widened for the actual clock error only.
+ *
+ * @return Error in ppm, at most LBM_MODEM_HAL_DRIFT_CRYSTAL_PPM.
+ */
+uint32_t smtc_modem_hal_drift_get_clock_error_ppm(void);
+
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_ENTROPY)
+
+/**
+ * @brief Get the random number pool counters.
+ *
+ * @param [out] stats Counters since boot.
+ */
+void smtc_modem_hal_entropy_stats_get(smtc_modem_hal_entropy_stats_t *stats);
+
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_RECOVERY)
+
+/**
+ * @brief Arm the recovery, for SMTC_MODEM_HAL_RECOVERY_POINT().
+ *
+ * @return Recovery point to set.
+ */
+jmp_buf *smtc_modem_hal_recovery_arm(void);
+
+/**
+ * @brief Report the end of smtc_modem_init(), from which an assert is recovered.
+ *
+ * @remark To be called after smtc_modem_init() and the unlock of the interrupts.
+ */
+void smtc_modem_hal_recovery_init_done(void);
+
+/**
+ * @brief Report an uplink, to measure the time from a fault to the first uplink.
+ *
+ * @remark To be called on each SMTC_MODEM_EVENT_TXDONE event.
+ */
+void smtc_modem_hal_recovery_uplink_done(void);
+
+/**
+ * @brief Get the recovery counters.
+ *
+ * @param [out] stats Counters since the last MCU reset.
+ */
+void smtc_modem_hal_recovery_stats_get(smtc_modem_hal_recovery_stats_t *stats);
+
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_WATCHDOG)
+
+/**
+ * @brief Limit the sleep time of the modem engine to feed the watchdog in time.
+ *
+ * @param [in] sleep_ms Sleep time returned by smtc_modem_run_engine().
+ *
+ * @return Sleep time, at most half the watchdog timeout.
+ */
+uint32_t smtc_modem_hal_watchdog_sleep_ms(const uint32_t sleep_ms);
+
+/**
+ * @brief Start timing a pass.
+ *
+ * @remark A pass still running at the end of its budget is logged at once.
+ *
+ * @param [in] source Timed pass.
+ *
+ * @return Start time, for smtc_modem_hal_supervisor_end().
+ */
+uint32_t smtc_modem_hal_supervisor_begin(const smtc_modem_hal_supervisor_source_t source);
+
+/**
+ * @brief End timing a pass, and log it if it exceeded its budget.
+ *
+ * @remark The end of an engine pass also feeds the watchdog.
+ *
+ * @param [in] source      Timed pass.
+ * @param [in] startCycles Start time, from smtc_modem_hal_supervisor_begin().
+ */
+void smtc_modem_hal_supervisor_end(const smtc_modem_hal_supervisor_source_t source, const uint32_t startCycles);
+
+/**
+ * @brief Get the supervisor counters of a pass.
+ *
+ * @param [in]  source Timed pass.
+ * @param [out] stats  Counters since boot.
+ */
+void smtc_modem_hal_supervisor_stats_get(const smtc_modem_hal_supervisor_source_t source,
+                                         smtc_modem_hal_supervisor_stats_t *stats);
+
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_BOARD_DELAY_CALIBRATION)
+
+/**
+ * @brief Calibrate the board delay, or load the stored calibration.
+ *
+ * @remark To be called before smtc_modem_init(), while the radio is unused.
+ *         A measurement resets the radio and leaves it in sleep mode. It
+ *         runs again when the stored calibration is of another board or
+ *         radio SPI configuration.
+ *
+ * @param [in] radio_context Radio implementation parameters.
+ *
+ * @return 0 on success, negative error code otherwise.
+ */
+int smtc_modem_hal_board_delay_calibrate(const void *radio_context);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SMTC_MODEM_HAL_EXT_H
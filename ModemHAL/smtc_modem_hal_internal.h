@@ -0,0 +1,155 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Functions shared between the source files of the LoRa Basics Modem HAL.
+*         Not to be used outside of the modem HAL.
+******************************************************************************/
+
+#ifndef SMTC_MODEM_HAL_INTERNAL_H
+#define SMTC_MODEM_HAL_INTERNAL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include "smtc_modem_hal_ext.h"
+
+struct gpio_dt_spec;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+#if defined(CONFIG_LBM_MODEM_HAL_LATENCY_STATS)
+void SmtcModemHalLatencyRecord(const smtc_modem_hal_latency_source_t source, const uint32_t irqCycles);
+#else
+static inline void SmtcModemHalLatencyRecord(const smtc_modem_hal_latency_source_t source, const uint32_t irqCycles)
+{
+}
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_DRIFT)
+int32_t SmtcModemHalDriftCompensationS(void);
+#else
+static inline int32_t SmtcModemHalDriftCompensationS(void)
+{
+   return 0;
+}
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_CONTEXT_JOURNAL)
+int SmtcModemHalJournalRead(const uint32_t context, uint8_t *buffer, const uint32_t maxSize);
+int SmtcModemHalJournalWrite(const uint32_t context, const uint8_t *buffer, const uint32_t size);
+bool SmtcModemHalJournalCompactDue(void);
+int SmtcModemHalJournalCompact(void);
+uint32_t SmtcModemHalJournalCompactions(void);
+#else
+static inline int SmtcModemHalJournalRead(const uint32_t context, uint8_t *buffer, const uint32_t maxSize)
+{
+   return -ENOTSUP;
+}
+
+static inline int SmtcModemHalJournalWrite(const uint32_t context, const uint8_t *buffer, const uint32_t size)
+{
+   return -ENOTSUP;
+}
+
+static inline bool SmtcModemHalJournalCompactDue(void)
+{
+   return false;
+}
+
+static inline int SmtcModemHalJournalCompact(void)
+{
+   return 0;
+}
+
+static inline uint32_t SmtcModemHalJournalCompactions(void)
+{
+   return 0;
+}
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_ENTROPY)
+uint32_t SmtcModemHalEntropyGet(void);
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_SUPPLY)
+bool SmtcModemHalSupplyGetMv(uint16_t *millivolts);
+uint8_t SmtcModemHalSupplyLevel(void);
+#else
+static inline bool SmtcModemHalSupplyGetMv(uint16_t *millivolts)
+{
+   return false;
+}
+
+static inline uint8_t SmtcModemHalSupplyLevel(void)
+{
+   return 254;
+}
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_WATCHDOG)
+void SmtcModemHalWatchdogFeed(void);
+void SmtcModemHalSupervisorReset(void);
+#else
+static inline void SmtcModemHalWatchdogFeed(void)
+{
+}
+
+static inline void SmtcModemHalSupervisorReset(void)
+{
+}
+#endif
+
+#if defined(CONFIG_LBM_MODEM_HAL_BOARD_DELAY_CALIBRATION)
+int8_t SmtcModemHalBoardDelayMs(void);
+#else
+static inline int8_t SmtcModemHalBoardDelayMs(void)
+{
+   return 1;
+}
+#endif
+
+// Platform layer, one backend per target: nRF, native_sim or generic Zephyr.
+void SmtcModemHalPlatformReset(void);
+void SmtcModemHalPlatformIrqClearPending(const struct gpio_dt_spec *gpio, const bool enabled);
+
+bool SmtcModemHalRadioIdle(void);
+void SmtcModemHalQuiesce(void);
+bool SmtcModemHalContextLocked(void);
+
+#if defined(CONFIG_LBM_MODEM_HAL_RECOVERY)
+void SmtcModemHalRecover(void);
+void SmtcModemHalRecoveryReboot(void);
+#else
+static inline void SmtcModemHalRecover(void)
+{
+}
+
+static inline void SmtcModemHalRecoveryReboot(void)
+{
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SMTC_MODEM_HAL_INTERNAL_H
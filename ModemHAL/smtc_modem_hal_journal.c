@@ -0,0 +1,515 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Append-only journal of the modem contexts that change on each join
+*         or uplink.
+*
+* @details  The journal is stored in the lbm_journal_partition, one page per
+*           flash sector. The active page starts with a full copy of each
+*           context, followed by records of the bytes changed by each store:
+*           the frame counter or DevNonce increments cost a few bytes instead
+*           of a rewrite of the context.
+*
+*           When the active page is full, the current contexts are copied to
+*           the next page, whose header is written last: a power loss during
+*           the copy leaves the previous page active.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_internal.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(ModemHALJournal, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define JOURNAL_PARTITION           FIXED_PARTITION_ID(lbm_journal_partition)
+#define JOURNAL_MAGIC               0x4A4D424C     // "LBMJ"
+#define JOURNAL_MAX_PAGES           8
+
+// Fill level of the active page from which it's compacted in advance.
+#define JOURNAL_COMPACT_LEVEL(size) (((size) * 3) / 4)
+
+// Records are padded to this size, a multiple of the flash write block size.
+#define JOURNAL_ALIGN               8
+
+#define JOURNAL_CONTEXTS            (CONTEXT_SECURE_ELEMENT + 1)
+#define JOURNAL_DATA_MAX_SIZE       ROUND_UP(CONFIG_LBM_MODEM_HAL_CONTEXT_MAX_SIZE, JOURNAL_ALIGN)
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef enum
+{
+   JOURNAL_RECORD_FULL = 1,         // Whole context, sets its size
+   JOURNAL_RECORD_DIFF = 2,         // Changed bytes of the context
+} JournalRecordKind_t;
+
+typedef struct __packed
+{
+   uint32_t magic;
+   uint32_t sequence;               // Incremented on each compaction
+} JournalPageHeader_t;
+
+typedef struct __packed
+{
+   uint8_t  context;                // modem_context_type_t
+   uint8_t  kind;                   // JournalRecordKind_t
+   uint16_t offset;                 // First byte of the data in the context
+   uint16_t length;                 // Data length, before padding
+   uint16_t crc;                    // CRC of the header fields above and of the data
+} JournalRecordHeader_t;
+
+typedef struct
+{
+   bool        known;               // The journal holds this context
+   uint16_t    size;
+   uint8_t     data[CONFIG_LBM_MODEM_HAL_CONTEXT_MAX_SIZE];
+} JournalContext_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static const struct flash_area   *journalArea;
+static bool                      journalLoaded = false;
+static uint32_t                  journalPageSize;
+static uint32_t                  journalPages;
+static int32_t                   journalPage = -1;          // Active page, -1 if none
+static uint32_t                  journalSequence;
+static uint32_t                  journalWriteOffset;        // In the active page
+static uint32_t                  journalCompactions;
+
+// Contexts as stored in the journal.
+static JournalContext_t          journalContexts[JOURNAL_CONTEXTS];
+
+// Record being written or read.
+static uint8_t __aligned(4)      journalRecord[sizeof(JournalRecordHeader_t) + JOURNAL_DATA_MAX_SIZE];
+
+BUILD_ASSERT(sizeof(JournalPageHeader_t) == JOURNAL_ALIGN);
+BUILD_ASSERT(sizeof(JournalRecordHeader_t) == JOURNAL_ALIGN);
+BUILD_ASSERT(CONFIG_LBM_MODEM_HAL_CONTEXT_MAX_SIZE <= UINT16_MAX);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static int JournalLoad(void);
+static void JournalReplay(uint32_t page);
+static uint32_t JournalRecordBuild(uint8_t context, JournalRecordKind_t kind, const uint8_t *data,
+                                   uint16_t offset, uint16_t length);
+static uint16_t JournalRecordCrc(const JournalRecordHeader_t *header, const uint8_t *data);
+static int JournalCompact(uint8_t context, const uint8_t *buffer, uint16_t size);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Read a context from the journal.
+ *
+ * @remark Called with the context lock held.
+ *
+ * @param [in]  context Context type.
+ * @param [out] buffer  Context value.
+ * @param [in]  maxSize Buffer size.
+ *
+ * @return Context size, -ENOENT if the journal doesn't hold the context, or
+ *         another negative error.
+ */
+int SmtcModemHalJournalRead(const uint32_t context, uint8_t *buffer, const uint32_t maxSize)
+{
+   int rc = JournalLoad();
+
+   if (rc != 0)
+   {
+      return rc;
+   }
+
+   if ((context >= JOURNAL_CONTEXTS) || !journalContexts[context].known)
+   {
+      return -ENOENT;
+   }
+
+   if (journalContexts[context].size > maxSize)
+   {
+      return -ENOSPC;
+   }
+
+   memcpy(buffer, journalContexts[context].data, journalContexts[context].size);
+   return journalContexts[context].size;
+}
+
+/**
+ * @brief Write a context to the journal.
+ *
+ * @remark Called with the context lock held.
+ *
+ * @return Number of bytes written to flash, or a negative error.
+ */
+int SmtcModemHalJournalWrite(const uint32_t context, const uint8_t *buffer, const uint32_t size)
+{
+   JournalContext_t *stored;
+   uint32_t first;
+   uint32_t last;
+   uint32_t recordSize;
+   int rc = JournalLoad();
+
+   if (rc != 0)
+   {
+      return rc;
+   }
+
+   if ((context >= JOURNAL_CONTEXTS) || (size > CONFIG_LBM_MODEM_HAL_CONTEXT_MAX_SIZE))
+   {
+      return -EINVAL;
+   }
+
+   stored = &journalContexts[context];
+
+   if (stored->known && (stored->size == size))
+   {
+      // Record the changed bytes only.
+      for (first = 0; (first < size) && (stored->data[first] == buffer[first]); first++)
+      {
+      }
+
+      if (first == size)
+      {
+         return 0;
+      }
+
+      for (last = size - 1; stored->data[last] == buffer[last]; last--)
+      {
+      }
+
+      recordSize = JournalRecordBuild(context, JOURNAL_RECORD_DIFF, &buffer[first], first, last - first + 1);
+   }
+   else
+   {
+      recordSize = JournalRecordBuild(context, JOURNAL_RECORD_FULL, buffer, 0, size);
+   }
+
+   if ((journalPage < 0) || (journalWriteOffset + recordSize > journalPageSize))
+   {
+      return JournalCompact(context, buffer, size);
+   }
+
+   rc = flash_area_write(journalArea, (journalPage * journalPageSize) + journalWriteOffset,
+                         journalRecord, recordSize);
+   if (rc != 0)
+   {
+      // The record may be partly written: don't append after it.
+      journalWriteOffset = journalPageSize;
+      return rc;
+   }
+
+   journalWriteOffset += recordSize;
+   memcpy(stored->data, buffer, size);
+   stored->size = size;
+   stored->known = true;
+
+   return recordSize;
+}
+
+/**
+ * @brief Check if the active page should be compacted before it's full.
+ *
+ * @remark Called with the context lock held.
+ */
+bool SmtcModemHalJournalCompactDue(void)
+{
+   return (journalArea != NULL) && (journalPage >= 0) &&
+          (journalWriteOffset > JOURNAL_COMPACT_LEVEL(journalPageSize));
+}
+
+/**
+ * @brief Compact the journal now, so no store has to compact it.
+ *
+ * @remark Called with the context lock held, in a radio idle time: the sector
+ *         erase can stall the CPU.
+ *
+ * @return Number of bytes written to flash, or a negative error.
+ */
+int SmtcModemHalJournalCompact(void)
+{
+   if (!SmtcModemHalJournalCompactDue())
+   {
+      return 0;
+   }
+
+   return JournalCompact(JOURNAL_CONTEXTS, NULL, 0);
+}
+
+/**
+ * @brief Get the number of journal compactions since boot.
+ */
+uint32_t SmtcModemHalJournalCompactions(void)
+{
+   return journalCompactions;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Open the journal partition and replay its active page, once.
+ *
+ * @return 0 on success, a negative error otherwise.
+ */
+static int JournalLoad(void)
+{
+   struct flash_sector sectors[JOURNAL_MAX_PAGES];
+   uint32_t sectorCount = ARRAY_SIZE(sectors);
+   JournalPageHeader_t header;
+   int rc;
+
+   if (journalLoaded)
+   {
+      return (journalArea != NULL) ? 0 : -ENODEV;
+   }
+   journalLoaded = true;
+
+   rc = flash_area_get_sectors(JOURNAL_PARTITION, &sectorCount, sectors);
+   if ((rc != 0) || (sectorCount < 2) || (sectors[0].fs_size != sectors[sectorCount - 1].fs_size))
+   {
+      LOG_ERR("Journal partition needs 2 to %u equal sectors. Error=%d", JOURNAL_MAX_PAGES, rc);
+      return -ENODEV;
+   }
+
+   rc = flash_area_open(JOURNAL_PARTITION, &journalArea);
+   if ((rc == 0) && (JOURNAL_ALIGN % flash_area_align(journalArea) != 0))
+   {
+      LOG_ERR("Journal write block size %u not supported.", flash_area_align(journalArea));
+      flash_area_close(journalArea);
+      rc = -ENOTSUP;
+   }
+
+   if (rc != 0)
+   {
+      journalArea = NULL;
+      return rc;
+   }
+
+   journalPageSize = sectors[0].fs_size;
+   journalPages = sectorCount;
+
+   for (uint32_t page = 0; page < journalPages; page++)
+   {
+      if ((flash_area_read(journalArea, page * journalPageSize, &header, sizeof(header)) == 0) &&
+          (header.magic == JOURNAL_MAGIC) &&
+          ((journalPage < 0) || ((int32_t) (header.sequence - journalSequence) > 0)))
+      {
+         journalPage = page;
+         journalSequence = header.sequence;
+      }
+   }
+
+   if (journalPage >= 0)
+   {
+      JournalReplay(journalPage);
+   }
+
+   LOG_DBG("Journal page %d, sequence %u, %u bytes used.", journalPage, journalSequence, journalWriteOffset);
+   return 0;
+}
+
+/**
+ * @brief Apply the records of a page to the contexts.
+ *
+ * @param [in] page Page to replay.
+ */
+static void JournalReplay(uint32_t page)
+{
+   const uint32_t pageStart = page * journalPageSize;
+   const uint8_t erased = flash_area_erased_val(journalArea);
+   JournalRecordHeader_t *header = (JournalRecordHeader_t *) journalRecord;
+   uint8_t *data = &journalRecord[sizeof(JournalRecordHeader_t)];
+   uint32_t offset = sizeof(JournalPageHeader_t);
+
+   while (offset + sizeof(JournalRecordHeader_t) <= journalPageSize)
+   {
+      JournalContext_t *context;
+      uint32_t dataSize;
+
+      if (flash_area_read(journalArea, pageStart + offset, header, sizeof(*header)) != 0)
+      {
+         break;
+      }
+
+      if ((header->context == erased) && (header->kind == erased))
+      {
+         journalWriteOffset = offset;
+         return;
+      }
+
+      dataSize = ROUND_UP(header->length, JOURNAL_ALIGN);
+      if ((header->context >= JOURNAL_CONTEXTS) ||
+          (header->offset + header->length > CONFIG_LBM_MODEM_HAL_CONTEXT_MAX_SIZE) ||
+          (offset + sizeof(*header) + dataSize > journalPageSize) ||
+          (flash_area_read(journalArea, pageStart + offset + sizeof(*header), data, dataSize) != 0) ||
+          (JournalRecordCrc(header, data) != header->crc))
+      {
+         break;
+      }
+
+      context = &journalContexts[header->context];
+      if (header->kind == JOURNAL_RECORD_FULL)
+      {
+         memcpy(context->data, data, header->length);
+         context->size = header->length;
+         context->known = true;
+      }
+      else if ((header->kind == JOURNAL_RECORD_DIFF) && context->known &&
+               (header->offset + header->length <= context->size))
+      {
+         memcpy(&context->data[header->offset], data, header->length);
+      }
+      else
+      {
+         break;
+      }
+
+      offset += sizeof(*header) + dataSize;
+   }
+
+   // Torn or unknown record: the contexts are valid up to it, and the next
+   // write moves them to a new page.
+   LOG_WRN("Journal record at %u not valid.", offset);
+   journalWriteOffset = journalPageSize;
+}
+
+/**
+ * @brief Build a record in the record buffer.
+ *
+ * @return Record size, padding included.
+ */
+static uint32_t JournalRecordBuild(uint8_t context, JournalRecordKind_t kind, const uint8_t *data,
+                                   uint16_t offset, uint16_t length)
+{
+   JournalRecordHeader_t *header = (JournalRecordHeader_t *) journalRecord;
+   uint8_t *recordData = &journalRecord[sizeof(JournalRecordHeader_t)];
+   const uint32_t dataSize = ROUND_UP(length, JOURNAL_ALIGN);
+
+   header->context = context;
+   header->kind = kind;
+   header->offset = offset;
+   header->length = length;
+   memcpy(recordData, data, length);
+   memset(&recordData[length], 0, dataSize - length);
+   header->crc = JournalRecordCrc(header, recordData);
+
+   return sizeof(*header) + dataSize;
+}
+
+static uint16_t JournalRecordCrc(const JournalRecordHeader_t *header, const uint8_t *data)
+{
+   uint16_t crc = crc16_ccitt(0xFFFF, (const uint8_t *) header, offsetof(JournalRecordHeader_t, crc));
+
+   return crc16_ccitt(crc, data, header->length);
+}
+
+/**
+ * @brief Copy the contexts to the next page, with a new value of a context.
+ *
+ * @param [in] context New context type, JOURNAL_CONTEXTS for none.
+ * @param [in] buffer  New context value.
+ * @param [in] size    New context size.
+ *
+ * @return Number of bytes written to flash, or a negative error.
+ */
+static int JournalCompact(uint8_t context, const uint8_t *buffer, uint16_t size)
+{
+   const uint32_t page = (journalPage < 0) ? 0 : ((journalPage + 1) % journalPages);
+   const uint32_t pageStart = page * journalPageSize;
+   uint32_t offset = sizeof(JournalPageHeader_t);
+   JournalPageHeader_t header;
+   int rc;
+
+   rc = flash_area_erase(journalArea, pageStart, journalPageSize);
+
+   for (uint32_t i = 0; (i < JOURNAL_CONTEXTS) && (rc == 0); i++)
+   {
+      uint32_t recordSize;
+
+      if (i == context)
+      {
+         recordSize = JournalRecordBuild(i, JOURNAL_RECORD_FULL, buffer, 0, size);
+      }
+      else if (journalContexts[i].known)
+      {
+         recordSize = JournalRecordBuild(i, JOURNAL_RECORD_FULL, journalContexts[i].data, 0,
+                                         journalContexts[i].size);
+      }
+      else
+      {
+         continue;
+      }
+
+      if (offset + recordSize > journalPageSize)
+      {
+         rc = -ENOSPC;
+         break;
+      }
+
+      rc = flash_area_write(journalArea, pageStart + offset, journalRecord, recordSize);
+      offset += recordSize;
+   }
+
+   // The page becomes active with its header.
+   if (rc == 0)
+   {
+      header.magic = JOURNAL_MAGIC;
+      header.sequence = journalSequence + 1;
+      rc = flash_area_write(journalArea, pageStart, &header, sizeof(header));
+   }
+
+   if (rc != 0)
+   {
+      LOG_ERR("Journal compaction to page %u. Error=%d", page, rc);
+      return rc;
+   }
+
+   journalPage = page;
+   journalSequence++;
+   journalWriteOffset = offset;
+   journalCompactions++;
+
+   if (context < JOURNAL_CONTEXTS)
+   {
+      memcpy(journalContexts[context].data, buffer, size);
+      journalContexts[context].size = size;
+      journalContexts[context].known = true;
+   }
+
+   LOG_DBG("Journal compacted to page %u, sequence %u.", page, journalSequence);
+   return offset;
+}
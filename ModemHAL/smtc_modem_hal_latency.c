@@ -0,0 +1,169 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Dispatch latency of the modem timer and radio IRQ callbacks.
+*
+* @details  The interrupt handlers latch the cycle counter and the work queue
+*           handlers record the elapsed time when they start. The most recent
+*           samples of each interrupt are kept in a ring, and sorted on demand
+*           to get the percentiles.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include "smtc_modem_hal_ext.h"
+#include "smtc_modem_hal_internal.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(ModemHALLatency, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct LatencySamples_s
+{
+   uint32_t    samples[CONFIG_LBM_MODEM_HAL_LATENCY_SAMPLES];
+   uint32_t    next;
+   uint32_t    count;
+   uint32_t    maxUs;
+} LatencySamples_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static LatencySamples_t       latencySamples[SMTC_MODEM_HAL_LATENCY_SOURCES];
+static struct k_spinlock      latencyLock;
+
+static const char * const     latencyNames[SMTC_MODEM_HAL_LATENCY_SOURCES] = { "Timer", "DIO1" };
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static int LatencyCompare(const void *a, const void *b);
+static uint32_t LatencyPercentile(const uint32_t *sorted, uint32_t count, uint32_t percent);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Get the dispatch latency of the callbacks of an interrupt.
+ *
+ * @param [in]  source  Interrupt.
+ * @param [out] latency Dispatch latency.
+ */
+void smtc_modem_hal_latency_get(smtc_modem_hal_latency_source_t source, smtc_modem_hal_latency_t *latency)
+{
+   static uint32_t sorted[CONFIG_LBM_MODEM_HAL_LATENCY_SAMPLES];
+   static K_MUTEX_DEFINE(sortedLock);
+   uint32_t samples;
+
+   k_mutex_lock(&sortedLock, K_FOREVER);
+
+   k_spinlock_key_t key = k_spin_lock(&latencyLock);
+   samples = MIN(latencySamples[source].count, CONFIG_LBM_MODEM_HAL_LATENCY_SAMPLES);
+   memcpy(sorted, latencySamples[source].samples, samples * sizeof(sorted[0]));
+   latency->count = latencySamples[source].count;
+   latency->maxUs = latencySamples[source].maxUs;
+   k_spin_unlock(&latencyLock, key);
+
+   qsort(sorted, samples, sizeof(sorted[0]), LatencyCompare);
+   latency->p50Us = LatencyPercentile(sorted, samples, 50);
+   latency->p99Us = LatencyPercentile(sorted, samples, 99);
+
+   k_mutex_unlock(&sortedLock);
+}
+
+/**
+ * @brief Log the dispatch latency of the timer and radio IRQ callbacks.
+ */
+void smtc_modem_hal_latency_log(void)
+{
+   smtc_modem_hal_latency_t result;
+
+   for (uint32_t source = 0; source < SMTC_MODEM_HAL_LATENCY_SOURCES; source++)
+   {
+      smtc_modem_hal_latency_get(source, &result);
+      LOG_INF("%-5s n=%u p50=%u us p99=%u us max=%u us", latencyNames[source], result.count,
+              result.p50Us, result.p99Us, result.maxUs);
+   }
+}
+
+/**
+ * @brief Clear the dispatch latency samples.
+ */
+void smtc_modem_hal_latency_reset(void)
+{
+   k_spinlock_key_t key = k_spin_lock(&latencyLock);
+
+   memset(latencySamples, 0, sizeof(latencySamples));
+   k_spin_unlock(&latencyLock, key);
+}
+
+/**
+ * @brief Record the dispatch latency of a callback, when it starts.
+ *
+ * @param [in] source    Interrupt.
+ * @param [in] irqCycles Cycle counter latched by the interrupt handler.
+ */
+void SmtcModemHalLatencyRecord(const smtc_modem_hal_latency_source_t source, const uint32_t irqCycles)
+{
+   const uint32_t latencyUs = k_cyc_to_us_floor32(k_cycle_get_32() - irqCycles);
+   LatencySamples_t *stats = &latencySamples[source];
+   k_spinlock_key_t key = k_spin_lock(&latencyLock);
+
+   stats->samples[stats->next] = latencyUs;
+   stats->next = (stats->next + 1) % CONFIG_LBM_MODEM_HAL_LATENCY_SAMPLES;
+   stats->count++;
+   stats->maxUs = MAX(stats->maxUs, latencyUs);
+   k_spin_unlock(&latencyLock, key);
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static int LatencyCompare(const void *a, const void *b)
+{
+   const uint32_t valueA = *(const uint32_t *) a;
+   const uint32_t valueB = *(const uint32_t *) b;
+
+   return (valueA > valueB) - (valueA < valueB);
+}
+
+/**
+ * @brief Get a percentile of sorted samples, with the nearest-rank method.
+ *
+ * @return Percentile, 0 if there is no sample.
+ */
+static uint32_t LatencyPercentile(const uint32_t *sorted, uint32_t count, uint32_t percent)
+{
+   if (count == 0)
+   {
+      return 0;
+   }
+
+   return sorted[((count * percent) + 99) / 100 - 1];
+}
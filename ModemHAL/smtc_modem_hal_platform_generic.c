@@ -0,0 +1,54 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Generic Zephyr platform layer of the LoRa Basics Modem HAL.
+*
+* @details  Only uses the Zephyr driver API. The GPIO API can't clear a latched
+*           interrupt, so the interrupt is configured again, which drops it
+*           with most GPIO drivers.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/reboot.h>
+
+#include "smtc_modem_hal_internal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Reset the MCU.
+ */
+void SmtcModemHalPlatformReset(void)
+{
+   sys_reboot(SYS_REBOOT_COLD);
+}
+
+/**
+ * @brief Clear the interrupt latched for a GPIO.
+ *
+ * @param [in] gpio    Interrupt GPIO.
+ * @param [in] enabled True if the GPIO interrupt is enabled.
+ */
+void SmtcModemHalPlatformIrqClearPending(const struct gpio_dt_spec *gpio, const bool enabled)
+{
+   if (enabled)
+   {
+      gpio_pin_interrupt_configure_dt(gpio, GPIO_INT_DISABLE);
+      gpio_pin_interrupt_configure_dt(gpio, GPIO_INT_EDGE_TO_ACTIVE);
+   }
+}
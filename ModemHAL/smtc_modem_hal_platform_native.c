@@ -0,0 +1,56 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  native_sim platform layer of the LoRa Basics Modem HAL.
+*
+* @details  The emulated GPIO controller doesn't latch the edges of a disabled
+*           interrupt, so there is nothing to clear. The MCU reset restarts the
+*           executable when reboot is enabled, otherwise exits it.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/reboot.h>
+#include <posix_board_if.h>
+
+#include "smtc_modem_hal_internal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Reset the MCU.
+ */
+void SmtcModemHalPlatformReset(void)
+{
+#if defined(CONFIG_REBOOT)
+   sys_reboot(SYS_REBOOT_COLD);
+#else
+   posix_exit(0);
+#endif
+}
+
+/**
+ * @brief Clear the interrupt latched for a GPIO.
+ *
+ * @param [in] gpio    Interrupt GPIO.
+ * @param [in] enabled True if the GPIO interrupt is enabled.
+ */
+void SmtcModemHalPlatformIrqClearPending(const struct gpio_dt_spec *gpio, const bool enabled)
+{
+   ARG_UNUSED(gpio);
+   ARG_UNUSED(enabled);
+}
@@ -0,0 +1,105 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  nRF platform layer of the LoRa Basics Modem HAL.
+*
+* @details  Clears the GPIOTE event latched for the radio IRQ pin, and resets
+*           the MCU through the NVIC.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <nrfx_gpiote.h>
+
+#include "smtc_modem_hal_internal.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(ModemHAL, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static uint32_t PlatformNrfPortNumber(const struct device *port);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Reset the MCU.
+ */
+void SmtcModemHalPlatformReset(void)
+{
+   NVIC_SystemReset();
+}
+
+/**
+ * @brief Clear the interrupt latched for a GPIO.
+ *
+ * @param [in] gpio    Interrupt GPIO.
+ * @param [in] enabled True if the GPIO interrupt is enabled.
+ */
+void SmtcModemHalPlatformIrqClearPending(const struct gpio_dt_spec *gpio, const bool enabled)
+{
+   const uint32_t portNumber = PlatformNrfPortNumber(gpio->port);
+   const uint32_t absPin = NRF_GPIO_PIN_MAP(portNumber, gpio->pin);
+   uint8_t ch;
+   nrfx_err_t err = nrfx_gpiote_channel_get(absPin, &ch);
+
+   ARG_UNUSED(enabled);
+
+   if (err != NRFX_SUCCESS)
+   {
+      LOG_ERR("GPIOTE channel error: %u", (uint32_t) err);
+   }
+   else
+   {
+      LOG_DBG("Clear IRQ for GPIO Port=%u Pin=%u", portNumber, gpio->pin);
+
+      nrf_gpiote_event_clear(NRF_GPIOTE, nrf_gpiote_in_event_get(ch));
+   }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Get the nRF port number of a GPIO controller.
+ *
+ * @param [in] port GPIO controller.
+ *
+ * @return Port number, from the port property of its devicetree node.
+ */
+static uint32_t PlatformNrfPortNumber(const struct device *port)
+{
+#define PLATFORM_NRF_GPIO_PORT(node)         \
+   if (port == DEVICE_DT_GET(node))          \
+   {                                         \
+      return DT_PROP(node, port);            \
+   }
+
+   DT_FOREACH_STATUS_OKAY(nordic_nrf_gpio, PLATFORM_NRF_GPIO_PORT)
+
+#undef PLATFORM_NRF_GPIO_PORT
+
+   LOG_ERR("Unknown GPIO port %s", port->name);
+   return 0;
+}
@@ -0,0 +1,236 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  In-place recovery of the LoRa Basics Modem after an assert.
+*
+* @details  The application sets a recovery point before initializing the
+*           modem, in the thread that runs the modem engine, and reports the
+*           end of the init. An assert in this thread stops the modem timer and
+*           radio IRQ, resets the radio and jumps back to the recovery point,
+*           where the application initializes the modem again from its
+*           contexts, still in RAM.
+*
+*           The jump doesn't unwind the interrupted calls. An assert in another
+*           thread or an interrupt, in the init, with the context lock or the
+*           interrupts held, or too many recoveries in a row, escalate to the
+*           MCU reset. The time from the fault to the first uplink is reported
+*           for both paths.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <setjmp.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_ext.h"
+#include "smtc_modem_hal_internal.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(ModemHALRecovery, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define RECOVERY_RETAINED_MAGIC     0x5246424C     // "LBFR"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+// Fault escalated to an MCU reset, kept in RAM across the reset.
+typedef struct RecoveryRetained_s
+{
+   uint32_t magic;
+   uint32_t faultToResetMs;         // Time from the fault to the reset
+} RecoveryRetained_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static RecoveryRetained_t __attribute__((section(".noinit"))) recoveryRetained;
+
+static jmp_buf                recoveryPoint;
+static k_tid_t                recoveryThread;
+
+// The modem is initialized: the recovery can jump back.
+static bool                   recoveryReady;
+
+// Uptime of the recent recoveries, to escalate.
+static int64_t                recoveryTimesMs[CONFIG_LBM_MODEM_HAL_RECOVERY_MAX];
+static uint32_t               recoveryIndex;
+
+// Uptime of the fault waiting for its first uplink, -1 if none.
+static int64_t                faultTimeMs = -1;
+
+static smtc_modem_hal_recovery_stats_t recoveryStats;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static bool RecoveryIrqLocked(void);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Arm the recovery, for SMTC_MODEM_HAL_RECOVERY_POINT().
+ *
+ * @return Recovery point to set.
+ */
+jmp_buf *smtc_modem_hal_recovery_arm(void)
+{
+   recoveryThread = k_current_get();
+   recoveryReady = false;
+   return &recoveryPoint;
+}
+
+/**
+ * @brief Report the end of smtc_modem_init(), from which an assert is recovered.
+ */
+void smtc_modem_hal_recovery_init_done(void)
+{
+   recoveryReady = true;
+}
+
+/**
+ * @brief Report an uplink, to measure the time from a fault to the first uplink.
+ */
+void smtc_modem_hal_recovery_uplink_done(void)
+{
+   const int64_t nowMs = k_uptime_get();
+
+   if (recoveryRetained.magic == RECOVERY_RETAINED_MAGIC)
+   {
+      // The uptime restarted at the reset: the boot time isn't counted.
+      recoveryStats.lastResetMs = recoveryRetained.faultToResetMs + (uint32_t) nowMs;
+      recoveryRetained.magic = 0;
+      LOG_INF("First uplink %u ms after the fault, with a reset.", recoveryStats.lastResetMs);
+   }
+   else if (faultTimeMs >= 0)
+   {
+      recoveryStats.lastRecoveryMs = (uint32_t) (nowMs - faultTimeMs);
+      LOG_INF("First uplink %u ms after the fault, recovered in place.", recoveryStats.lastRecoveryMs);
+   }
+
+   faultTimeMs = -1;
+}
+
+/**
+ * @brief Get the recovery counters.
+ *
+ * @param [out] stats Counters since the last MCU reset.
+ */
+void smtc_modem_hal_recovery_stats_get(smtc_modem_hal_recovery_stats_t *stats)
+{
+   *stats = recoveryStats;
+}
+
+/**
+ * @brief Recover the modem in place after an assert, if possible.
+ *
+ * @remark Doesn't return on recovery. Returns to escalate to an MCU reset.
+ */
+void SmtcModemHalRecover(void)
+{
+   const int64_t nowMs = k_uptime_get();
+   const int64_t oldestMs = recoveryTimesMs[recoveryIndex];
+
+   faultTimeMs = nowMs;
+
+   if ((recoveryThread == NULL) || k_is_in_isr() || (k_current_get() != recoveryThread))
+   {
+      LOG_ERR("Assert outside of the modem thread.");
+      return;
+   }
+
+   // Initializing again from a half-done init would start from its state.
+   if (!recoveryReady)
+   {
+      LOG_ERR("Assert in the modem init.");
+      return;
+   }
+
+   // The jump wouldn't release the lock, and the data it protects may be half updated.
+   if (SmtcModemHalContextLocked() || RecoveryIrqLocked())
+   {
+      LOG_ERR("Assert with a modem HAL lock held.");
+      return;
+   }
+
+   // The oldest of the last recoveries is in the window: too many.
+   if ((oldestMs != 0) && (nowMs - oldestMs < (CONFIG_LBM_MODEM_HAL_RECOVERY_WINDOW_S * MSEC_PER_SEC)))
+   {
+      LOG_ERR("%u recoveries in %u s.", CONFIG_LBM_MODEM_HAL_RECOVERY_MAX, CONFIG_LBM_MODEM_HAL_RECOVERY_WINDOW_S);
+      return;
+   }
+
+   recoveryTimesMs[recoveryIndex] = nowMs;
+   recoveryIndex = (recoveryIndex + 1) % ARRAY_SIZE(recoveryTimesMs);
+   recoveryStats.recoveries++;
+
+   LOG_WRN("Recovering the modem in place.");
+   SmtcModemHalQuiesce();
+
+   // The interrupted pass won't end: stop its supervision.
+   SmtcModemHalSupervisorReset();
+
+   longjmp(recoveryPoint, 1);
+}
+
+/**
+ * @brief Keep the time from the fault across the MCU reset.
+ *
+ * @remark Called just before the MCU reset.
+ */
+void SmtcModemHalRecoveryReboot(void)
+{
+   if (faultTimeMs >= 0)
+   {
+      recoveryRetained.faultToResetMs = (uint32_t) (k_uptime_get() - faultTimeMs);
+      recoveryRetained.magic = RECOVERY_RETAINED_MAGIC;
+   }
+   else
+   {
+      recoveryRetained.magic = 0;
+   }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Check if the interrupts are locked, by irq_lock() or a spinlock.
+ *
+ * @return true if locked.
+ */
+static bool RecoveryIrqLocked(void)
+{
+   const unsigned int key = irq_lock();
+   const bool locked = !arch_irq_unlocked(key);
+
+   irq_unlock(key);
+   return locked;
+}
@@ -0,0 +1,236 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Supply voltage measurement for the battery level and voltage of the
+*         modem HAL.
+*
+* @details  The supply is sampled with the first io-channels ADC channel of the
+*           zephyr,user node, VDD on the nRF52840 SAADC. A periodic work starts
+*           an asynchronous, oversampled read while the radio is asleep: the
+*           supply sags during a TX. The completed read is filtered from the
+*           ADC interrupt, so the getters return the cached value at once.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/sys/util.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_internal.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(ModemHALSupply, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+// Conversions averaged in a measurement.
+#define SUPPLY_SAMPLES              8
+
+// Filter weight of a new measurement: 1 / 2^shift.
+#define SUPPLY_FILTER_SHIFT         2
+
+// Delay before retrying a measurement while the radio is active.
+#define SUPPLY_RETRY_MS             500
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static const struct adc_dt_spec supplyChannel = ADC_DT_SPEC_GET_BY_IDX(DT_PATH(zephyr_user), 0);
+
+static int16_t                supplySamples[SUPPLY_SAMPLES];
+static struct k_poll_signal   supplySignal;
+
+// Filtered supply voltage, written from the ADC interrupt.
+static atomic_t               supplyMv;
+static bool                   supplyValid = false;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static enum adc_action SupplyAdcCallback(const struct device *dev, const struct adc_sequence *sequence,
+                                         uint16_t samplingIndex);
+static void SupplyWorkHandler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(supplyWork, SupplyWorkHandler);
+
+static const struct adc_sequence_options supplyOptions = {
+   .callback = SupplyAdcCallback,
+   .extra_samplings = SUPPLY_SAMPLES - 1,
+   .interval_us = 0,
+};
+
+static struct adc_sequence    supplySequence = {
+   .options = &supplyOptions,
+   .buffer = supplySamples,
+   .buffer_size = sizeof(supplySamples),
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Get the filtered supply voltage.
+ *
+ * @param [out] millivolts Supply voltage.
+ *
+ * @return True once the supply has been measured.
+ */
+bool SmtcModemHalSupplyGetMv(uint16_t *millivolts)
+{
+   *millivolts = (uint16_t) atomic_get(&supplyMv);
+   return supplyValid;
+}
+
+/**
+ * @brief Get the battery level from the filtered supply voltage.
+ *
+ * @return Battery level, from 1 (empty) to 254 (full), 255 if not measured yet.
+ */
+uint8_t SmtcModemHalSupplyLevel(void)
+{
+   const int32_t rangeMv = CONFIG_LBM_MODEM_HAL_SUPPLY_FULL_MV - CONFIG_LBM_MODEM_HAL_SUPPLY_EMPTY_MV;
+   uint16_t millivolts;
+   int32_t levelMv;
+
+   if (!SmtcModemHalSupplyGetMv(&millivolts))
+   {
+      return 255;
+   }
+
+   levelMv = CLAMP((int32_t) millivolts - CONFIG_LBM_MODEM_HAL_SUPPLY_EMPTY_MV, 0, rangeMv);
+   return (uint8_t) (1 + (levelMv * 253) / rangeMv);
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief ADC sampling callback, filters the measurement after the last sampling.
+ *
+ * @remark Called from the ADC interrupt.
+ */
+static enum adc_action SupplyAdcCallback(const struct device *dev, const struct adc_sequence *sequence,
+                                         uint16_t samplingIndex)
+{
+   int32_t sum = 0;
+   int32_t millivolts;
+   int32_t filtered;
+
+   // Samplings are stored one after the other in the buffer.
+   if (samplingIndex < sequence->options->extra_samplings)
+   {
+      return ADC_ACTION_CONTINUE;
+   }
+
+   // The radio woke up during the conversions: the supply may be sagging.
+   if (!SmtcModemHalRadioIdle())
+   {
+      return ADC_ACTION_FINISH;
+   }
+
+   for (uint32_t i = 0; i < SUPPLY_SAMPLES; i++)
+   {
+      sum += supplySamples[i];
+   }
+   millivolts = sum / SUPPLY_SAMPLES;
+
+   if (adc_raw_to_millivolts_dt(&supplyChannel, &millivolts) != 0)
+   {
+      return ADC_ACTION_FINISH;
+   }
+
+   if (!supplyValid)
+   {
+      filtered = millivolts;
+   }
+   else
+   {
+      filtered = atomic_get(&supplyMv);
+      filtered += (millivolts - filtered) / (1 << SUPPLY_FILTER_SHIFT);
+   }
+
+   atomic_set(&supplyMv, filtered);
+   supplyValid = true;
+
+   return ADC_ACTION_FINISH;
+}
+
+/**
+ * @brief Supply measurement work handler.
+ *
+ * @param [in] work Work object.
+ */
+static void SupplyWorkHandler(struct k_work *work)
+{
+   int rc;
+
+   // Also waits for smtc_modem_init(), after this SYS_INIT.
+   if (!SmtcModemHalRadioIdle())
+   {
+      k_work_schedule(&supplyWork, K_MSEC(SUPPLY_RETRY_MS));
+      return;
+   }
+
+   k_poll_signal_reset(&supplySignal);
+   rc = adc_read_async(supplyChannel.dev, &supplySequence, &supplySignal);
+   if (rc != 0)
+   {
+      LOG_ERR("Supply ADC read. Error=%d", rc);
+   }
+
+   k_work_schedule(&supplyWork, K_SECONDS(CONFIG_LBM_MODEM_HAL_SUPPLY_PERIOD_S));
+}
+
+static int SupplyInit(void)
+{
+   int rc;
+
+   if (!adc_is_ready_dt(&supplyChannel))
+   {
+      LOG_ERR("Supply ADC not ready.");
+      return -ENODEV;
+   }
+
+   rc = adc_channel_setup_dt(&supplyChannel);
+   if (rc == 0)
+   {
+      rc = adc_sequence_init_dt(&supplyChannel, &supplySequence);
+   }
+
+   if (rc != 0)
+   {
+      LOG_ERR("Supply ADC setup. Error=%d", rc);
+      return rc;
+   }
+
+   k_poll_signal_init(&supplySignal);
+   k_work_schedule(&supplyWork, K_NO_WAIT);
+
+   return 0;
+}
+
+SYS_INIT(SupplyInit, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,130 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Time base of the LoRa Basics Modem HAL.
+*
+* @details  Conversions of the kernel uptime ticks to the 32-bit time units of
+*           the modem HAL, and comparisons of 32-bit times that wrap around.
+*
+*           The conversions are resolved at compile time from the tick rate.
+*           With a power-of-2 tick rate (e.g. the 32768 Hz RTC of the nRF52),
+*           a conversion is an exact 32.32 fixed-point multiply, without the
+*           64-bit division of the generic kernel conversions.
+******************************************************************************/
+
+#ifndef SMTC_MODEM_HAL_TIME_H
+#define SMTC_MODEM_HAL_TIME_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+#define SMTC_MODEM_HAL_TIME_TICKS_PER_SEC    CONFIG_SYS_CLOCK_TICKS_PER_SEC
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Convert uptime ticks to a time unit, rounding down.
+ *
+ * @remark The result wraps around at 32 bits, as the HAL times.
+ *
+ * @param [in] ticks       Uptime in ticks.
+ * @param [in] unitsPerSec Time unit, as a number of units per second (constant).
+ *
+ * @return Uptime in the time unit, modulo 2^32.
+ */
+static ALWAYS_INLINE uint32_t smtc_modem_hal_time_ticks_to_unit(const uint64_t ticks, const uint32_t unitsPerSec)
+{
+   const uint32_t ticksPerSec = SMTC_MODEM_HAL_TIME_TICKS_PER_SEC;
+
+   if ((unitsPerSec % ticksPerSec) == 0)
+   {
+      // Whole number of units per tick.
+      return (uint32_t) (ticks * (unitsPerSec / ticksPerSec));
+   }
+   else if (IS_POWER_OF_TWO(ticksPerSec) && (unitsPerSec < ticksPerSec))
+   {
+      // Exact 32.32 factor: the product is split in two 32 x 32 bits multiplies.
+      const uint64_t factor = ((uint64_t) unitsPerSec << 32) / ticksPerSec;
+
+      return (uint32_t) ((ticks >> 32) * factor) + (uint32_t) (((ticks & UINT32_MAX) * factor) >> 32);
+   }
+
+   return (uint32_t) (((ticks / ticksPerSec) * unitsPerSec) + (((ticks % ticksPerSec) * unitsPerSec) / ticksPerSec));
+}
+
+/**
+ * @brief Get the uptime in seconds.
+ */
+static inline uint32_t smtc_modem_hal_time_get_s(void)
+{
+   return smtc_modem_hal_time_ticks_to_unit(k_uptime_ticks(), 1);
+}
+
+/**
+ * @brief Get the uptime in milliseconds, wrapping every 49 days.
+ */
+static inline uint32_t smtc_modem_hal_time_get_ms(void)
+{
+   return smtc_modem_hal_time_ticks_to_unit(k_uptime_ticks(), 1000);
+}
+
+/**
+ * @brief Get the uptime in 0.1 milliseconds, wrapping every 4.9 days.
+ */
+static inline uint32_t smtc_modem_hal_time_get_100us(void)
+{
+   return smtc_modem_hal_time_ticks_to_unit(k_uptime_ticks(), 10000);
+}
+
+/**
+ * @brief Get the signed difference between two 32-bit times that may have wrapped.
+ *
+ * @remark Valid while the times are less than half the wrap period apart.
+ *
+ * @return a - b.
+ */
+static inline int32_t smtc_modem_hal_time_diff(const uint32_t a, const uint32_t b)
+{
+   return (int32_t) (a - b);
+}
+
+/**
+ * @brief Check whether a 32-bit time is after another, across the wrap around.
+ *
+ * @return True if a is strictly after b.
+ */
+static inline bool smtc_modem_hal_time_is_after(const uint32_t a, const uint32_t b)
+{
+   return smtc_modem_hal_time_diff(a, b) > 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SMTC_MODEM_HAL_TIME_H
@@ -0,0 +1,268 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Modem engine watchdog and latency supervisor.
+*
+* @details  The modem feeds a task watchdog channel through
+*           smtc_modem_hal_reload_wdog(), from smtc_modem_run_engine(). The
+*           task watchdog runs on a kernel timer, so it also works on
+*           native_sim, and falls back to the hardware watchdog0 when the
+*           board has one. A completed engine pass also feeds it.
+*
+*           The supervisor times each engine pass and each event callback
+*           against a budget. A pass still running at the end of its budget
+*           is logged at once, so a stalled SPI transaction or a blocking
+*           callback shows up long before the watchdog resets the MCU.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/device.h>
+#include <zephyr/task_wdt/task_wdt.h>
+#include <zephyr/sys/util.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_ext.h"
+#include "smtc_modem_hal_internal.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(ModemHALWatchdog, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+// Supervision of one source.
+typedef struct Supervisor_s
+{
+   const char *name;
+   uint32_t budgetMs;
+   struct k_timer budgetTimer;         // Expires when the running pass is over budget
+   smtc_modem_hal_supervisor_stats_t stats;
+} Supervisor_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+#if defined(CONFIG_LBM_MODEM_HAL_WATCHDOG_HW)
+static const struct device *const watchdogDevice = DEVICE_DT_GET(DT_ALIAS(watchdog0));
+#else
+static const struct device *const watchdogDevice = NULL;
+#endif
+
+static int                    watchdogChannel = -1;
+
+static Supervisor_t           supervisors[SMTC_MODEM_HAL_SUPERVISOR_SOURCES] = {
+   [SMTC_MODEM_HAL_SUPERVISOR_ENGINE] = {
+      .name = "Engine pass",
+      .budgetMs = CONFIG_LBM_MODEM_HAL_SUPERVISOR_ENGINE_BUDGET_MS,
+   },
+   [SMTC_MODEM_HAL_SUPERVISOR_EVENT] = {
+      .name = "Event callback",
+      .budgetMs = CONFIG_LBM_MODEM_HAL_SUPERVISOR_EVENT_BUDGET_MS,
+   },
+};
+
+static struct k_spinlock      supervisorLock;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static void SupervisorBudgetExpired(struct k_timer *timer);
+static void WatchdogExpired(int channel, void *userData);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/**
+ * @brief Limit the sleep time of the modem engine to feed the watchdog in time.
+ *
+ * @param [in] sleep_ms Sleep time returned by smtc_modem_run_engine().
+ *
+ * @return Sleep time, at most half the watchdog timeout.
+ */
+uint32_t smtc_modem_hal_watchdog_sleep_ms(const uint32_t sleep_ms)
+{
+   return MIN(sleep_ms, CONFIG_LBM_MODEM_HAL_WATCHDOG_TIMEOUT_MS / 2);
+}
+
+/**
+ * @brief Start timing a pass.
+ *
+ * @param [in] source Timed pass.
+ *
+ * @return Start time, for smtc_modem_hal_supervisor_end().
+ */
+uint32_t smtc_modem_hal_supervisor_begin(const smtc_modem_hal_supervisor_source_t source)
+{
+   Supervisor_t *supervisor = &supervisors[source];
+
+   k_timer_start(&supervisor->budgetTimer, K_MSEC(supervisor->budgetMs), K_NO_WAIT);
+   return k_cycle_get_32();
+}
+
+/**
+ * @brief End timing a pass, and log it if it exceeded its budget.
+ *
+ * @param [in] source      Timed pass.
+ * @param [in] startCycles Start time, from smtc_modem_hal_supervisor_begin().
+ */
+void smtc_modem_hal_supervisor_end(const smtc_modem_hal_supervisor_source_t source, const uint32_t startCycles)
+{
+   Supervisor_t *supervisor = &supervisors[source];
+   const uint32_t durationUs = k_cyc_to_us_floor32(k_cycle_get_32() - startCycles);
+   const bool overrun = (durationUs > supervisor->budgetMs * USEC_PER_MSEC);
+   k_spinlock_key_t key;
+
+   k_timer_stop(&supervisor->budgetTimer);
+
+   // A completed engine pass is alive, even if the modem didn't reload the watchdog.
+   if (source == SMTC_MODEM_HAL_SUPERVISOR_ENGINE)
+   {
+      SmtcModemHalWatchdogFeed();
+   }
+
+   key = k_spin_lock(&supervisorLock);
+   supervisor->stats.count++;
+   supervisor->stats.maxUs = MAX(supervisor->stats.maxUs, durationUs);
+   if (overrun)
+   {
+      supervisor->stats.overruns++;
+   }
+   k_spin_unlock(&supervisorLock, key);
+
+   if (overrun)
+   {
+      LOG_WRN("%s took %u us, budget %u ms.", supervisor->name, durationUs, supervisor->budgetMs);
+   }
+}
+
+/**
+ * @brief Get the supervisor counters of a pass.
+ *
+ * @param [in]  source Timed pass.
+ * @param [out] stats  Counters since boot.
+ */
+void smtc_modem_hal_supervisor_stats_get(const smtc_modem_hal_supervisor_source_t source,
+                                         smtc_modem_hal_supervisor_stats_t *stats)
+{
+   k_spinlock_key_t key = k_spin_lock(&supervisorLock);
+
+   *stats = supervisors[source].stats;
+   k_spin_unlock(&supervisorLock, key);
+}
+
+/**
+ * @brief Feed the modem engine watchdog.
+ */
+void SmtcModemHalWatchdogFeed(void)
+{
+   if (watchdogChannel >= 0)
+   {
+      task_wdt_feed(watchdogChannel);
+   }
+}
+
+/**
+ * @brief Stop timing the running passes, which won't end.
+ *
+ * @remark Called on a modem recovery, which leaves the passes of the modem
+ *         thread without their smtc_modem_hal_supervisor_end(). The watchdog
+ *         is fed: the engine is initialized again.
+ */
+void SmtcModemHalSupervisorReset(void)
+{
+   for (uint32_t i = 0; i < ARRAY_SIZE(supervisors); i++)
+   {
+      k_timer_stop(&supervisors[i].budgetTimer);
+   }
+
+   SmtcModemHalWatchdogFeed();
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Budget timer expiry, the pass is still running.
+ *
+ * @param [in] timer Budget timer of the pass.
+ */
+static void SupervisorBudgetExpired(struct k_timer *timer)
+{
+   Supervisor_t *supervisor = CONTAINER_OF(timer, Supervisor_t, budgetTimer);
+
+   LOG_WRN("%s still running after %u ms.", supervisor->name, supervisor->budgetMs);
+}
+
+/**
+ * @brief Watchdog expiry: the modem engine didn't run in time.
+ *
+ * @remark Called from the timer interrupt: the contexts aren't flushed, the
+ *         MCU is reset as after a fault.
+ *
+ * @param [in] channel  Task watchdog channel.
+ * @param [in] userData Unused.
+ */
+static void WatchdogExpired(int channel, void *userData)
+{
+   LOG_ERR("Modem engine watchdog expired.");
+   LOG_PANIC();
+   SmtcModemHalRecoveryReboot();
+   SmtcModemHalPlatformReset();
+}
+
+static int WatchdogInit(void)
+{
+   int rc;
+
+   for (uint32_t i = 0; i < ARRAY_SIZE(supervisors); i++)
+   {
+      k_timer_init(&supervisors[i].budgetTimer, SupervisorBudgetExpired, NULL);
+   }
+
+#if defined(CONFIG_LBM_MODEM_HAL_WATCHDOG_HW)
+   if (!device_is_ready(watchdogDevice))
+   {
+      LOG_ERR("Watchdog device not ready.");
+      return -ENODEV;
+   }
+#endif
+
+   rc = task_wdt_init(watchdogDevice);
+   if (rc == 0)
+   {
+      rc = task_wdt_add(CONFIG_LBM_MODEM_HAL_WATCHDOG_TIMEOUT_MS, WatchdogExpired, NULL);
+   }
+
+   if (rc < 0)
+   {
+      LOG_ERR("Watchdog init. Error=%d", rc);
+      return rc;
+   }
+
+   watchdogChannel = rc;
+   return 0;
+}
+
+SYS_INIT(WatchdogInit, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -57,6 +57,7 @@
 
 #include "ral_sx126x_bsp.h"
 #include "ralf_sx126x.h"
+#include "smtc_board_ralf.h"
 #include "sx126x_hal_context.h"
 
 #include <zephyr/logging/log.h>
@@ -68,7 +69,25 @@ LOG_MODULE_REGISTER(RALBSP, CONFIG_LBM_LOG_LEVEL);
  */
 
 #define LORA_RADIO_NODE_ID                   DT_ALIAS(lora0)
-#define DIO2_TX_ENABLE                       DT_PROP(LORA_RADIO_NODE_ID, dio2_tx_enable)
+
+// State of a radio, named after its devicetree node.
+#define RADIO_STATE(node_id)                 CONCAT(radioState, DT_DEP_ORD(node_id))
+
+#define RADIO_STATE_DEFINE(node_id)                                                          \
+   static sx126x_hal_state_t RADIO_STATE(node_id);
+
+// The context contains the SPI and GPIOs to the SX126X. The values are fetched from
+// the LoRa shield overlay devicetree configuration.
+#define RADIO_CONTEXT_INIT(node_id)                                                          \
+   {                                                                                         \
+      .spiSpec      = SPI_DT_SPEC_GET(node_id, SPI_WORD_SET(8) | SPI_TRANSFER_MSB, 0),       \
+      .gpioCs       = SPI_CS_GPIOS_DT_SPEC_GET(node_id),                                     \
+      .gpioReset    = GPIO_DT_SPEC_GET(node_id, reset_gpios),                                \
+      .gpioBusy     = GPIO_DT_SPEC_GET(node_id, busy_gpios),                                 \
+      .gpioDio1     = GPIO_DT_SPEC_GET(node_id, dio1_gpios),                                 \
+      .dio2TxEnable = DT_PROP(node_id, dio2_tx_enable),                                      \
+      .state        = &RADIO_STATE(node_id),                                                 \
+   },
 
 #define CD_SHIELD_SX1262_SUBGHZ_FREQ_MIN     150000000
 #define CD_SHIELD_SX1262_SUBGHZ_FREQ_MAX     960000000
@@ -395,16 +414,15 @@ const CDShieldSx1262PaPwrCfg_t paCfgTable[CD_SHIELD_SX1262_MAX_PWR - CD_SHIELD_S
  * --- PRIVATE VARIABLES -------------------------------------------------------
  */
 
-// The context contains the SPI and GPIOs to the SX126X. The values are fetched from
-// the LoRa shield overlay devicetree configuration.
-static const sx126x_hal_context_t radioContext = {
-   .spiSpec   = SPI_DT_SPEC_GET(LORA_RADIO_NODE_ID, SPI_WORD_SET(8) | SPI_TRANSFER_MSB, 0),
-   .gpioCs    = SPI_CS_GPIOS_DT_SPEC_GET(LORA_RADIO_NODE_ID),
-   .gpioReset = GPIO_DT_SPEC_GET(LORA_RADIO_NODE_ID, reset_gpios),
-   .gpioBusy  = GPIO_DT_SPEC_GET(LORA_RADIO_NODE_ID, busy_gpios),
-   .gpioDio1  = GPIO_DT_SPEC_GET(LORA_RADIO_NODE_ID, dio1_gpios),
+// One state, context and ralf_t per enabled SX1262 node.
+DT_FOREACH_STATUS_OKAY(semtech_sx1262, RADIO_STATE_DEFINE)
+
+static const sx126x_hal_context_t radioContexts[] = {
+   DT_FOREACH_STATUS_OKAY(semtech_sx1262, RADIO_CONTEXT_INIT)
 };
 
+static ralf_t radioRalfs[ARRAY_SIZE(radioContexts)];
+
 
 /*
  * -----------------------------------------------------------------------------
@@ -420,7 +438,7 @@ static const CDShieldSx1262PaPwrCfg_t *CDShieldSx1262PaPwrCfg(const uint32_t rfF
 
 /**
  * @brief Interface to initialise and return the ralf_t object corresponding to the
- *     SX126x shield.
+ *     SX126x shield, i.e. the radio of the lora0 alias.
  *
  * @warning It is up to the caller to ensure the context pointer stays valid for
  *    the life duration of the ralf_t created by this call.
@@ -429,10 +447,45 @@ static const CDShieldSx1262PaPwrCfg_t *CDShieldSx1262PaPwrCfg(const uint32_t rfF
  */
 ralf_t *smtc_board_initialise_and_get_ralf(void)
 {
-   static ralf_t localRalf = {0};
+   for (uint32_t i = 0; i < ARRAY_SIZE(radioContexts); i++)
+   {
+      if (radioContexts[i].state == &RADIO_STATE(LORA_RADIO_NODE_ID))
+      {
+         return smtc_board_get_ralf_by_index(i);
+      }
+   }
+   return NULL;
+}
 
-   localRalf = (ralf_t) RALF_SX126X_INSTANTIATE(&radioContext);
-   return &localRalf;
+/**
+ * @brief Get the number of SX126x radios of the board.
+ *
+ * @returns Number of radios.
+ */
+uint32_t smtc_board_get_ralf_count(void)
+{
+   return ARRAY_SIZE(radioContexts);
+}
+
+/**
+ * @brief Initialise and return the ralf_t object of one of the SX126x radios.
+ *
+ * @remark The radios are in the devicetree order, each with its own HAL state, so
+ *    several radios can be driven from different threads.
+ *
+ * @param [in] index Radio index, below smtc_board_get_ralf_count().
+ *
+ * @returns Pointer to the ralf_t object of the radio, or NULL.
+ */
+ralf_t *smtc_board_get_ralf_by_index(uint32_t index)
+{
+   if (index >= ARRAY_SIZE(radioContexts))
+   {
+      return NULL;
+   }
+
+   radioRalfs[index] = (ralf_t) RALF_SX126X_INSTANTIATE(&radioContexts[index]);
+   return &radioRalfs[index];
 }
 
 /**
@@ -456,7 +509,9 @@ void ral_sx126x_bsp_get_reg_mode(const void *context, sx126x_reg_mod_t *regMode)
  */
 void ral_sx126x_bsp_get_rf_switch_cfg(const void *context, bool *dio2IsSetAsRfSwitch)
 {
-   *dio2IsSetAsRfSwitch = DIO2_TX_ENABLE;
+   const sx126x_hal_context_t *sx126xContext = (const sx126x_hal_context_t *) context;
+
+   *dio2IsSetAsRfSwitch = sx126xContext->dio2TxEnable;
 
    LOG_DBG("DIO2 Tx Enable=%u", *dio2IsSetAsRfSwitch);
 }
@@ -59,6 +59,8 @@ extern "C"
  * --- DEPENDENCIES ------------------------------------------------------------
  */
 
+#include <stdint.h>
+
 #include "ralf_drv.h"
 
 /*
@@ -83,7 +85,7 @@ extern "C"
 
 /**
  * @brief Interface to initialise and return the ralf_t object corresponding to the
- *     SX126x shield.
+ *     SX126x shield, i.e. the radio of the lora0 alias.
  *
  * @warning It is up to the caller to ensure the context pointer stays valid for
  *    the life duration of the ralf_t created by this call.
@@ -92,6 +94,25 @@ extern "C"
  */
 ralf_t *smtc_board_initialise_and_get_ralf(void);
 
+/**
+ * @brief Get the number of SX126x radios of the board.
+ *
+ * @returns Number of radios.
+ */
+uint32_t smtc_board_get_ralf_count(void);
+
+/**
+ * @brief Initialise and return the ralf_t object of one of the SX126x radios.
+ *
+ * @remark The radios are in the devicetree order, each with its own HAL state, so
+ *    several radios can be driven from different threads.
+ *
+ * @param [in] index Radio index, below smtc_board_get_ralf_count().
+ *
+ * @returns Pointer to the ralf_t object of the radio, or NULL.
+ */
+ralf_t *smtc_board_get_ralf_by_index(uint32_t index);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,745 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Emulated SX1262 radio, as a Zephyr SPI emulator.
+*
+* @details  Differences with the real radio:
+*           - BUSY stays low in sleep mode, and any SPI transaction wakes the
+*             radio up, as the NSS glitch is not seen by the emulator.
+*           - The reset line is not monitored.
+*           - Only the LoRa time on air is computed, GFSK packets use a fixed
+*             time.
+******************************************************************************/
+
+#define DT_DRV_COMPAT semtech_sx1262
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/spi_emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/random/random.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+#include "sx126x_emul.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(RadioEmul, CONFIG_LBM_LOG_LEVEL);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+// Opcodes.
+#define OPCODE_CLR_IRQ_STATUS          0x02
+#define OPCODE_SET_DIO_IRQ_PARAMS      0x08
+#define OPCODE_WRITE_REGISTER          0x0D
+#define OPCODE_WRITE_BUFFER            0x0E
+#define OPCODE_GET_STATS               0x10
+#define OPCODE_GET_PKT_TYPE            0x11
+#define OPCODE_GET_IRQ_STATUS          0x12
+#define OPCODE_GET_RX_BUFFER_STATUS    0x13
+#define OPCODE_GET_PKT_STATUS          0x14
+#define OPCODE_GET_RSSI_INST           0x15
+#define OPCODE_GET_DEVICE_ERRORS       0x17
+#define OPCODE_READ_REGISTER           0x1D
+#define OPCODE_READ_BUFFER             0x1E
+#define OPCODE_SET_STANDBY             0x80
+#define OPCODE_SET_RX                  0x82
+#define OPCODE_SET_TX                  0x83
+#define OPCODE_SET_SLEEP               0x84
+#define OPCODE_SET_RF_FREQUENCY        0x86
+#define OPCODE_SET_PKT_TYPE            0x8A
+#define OPCODE_SET_MODULATION_PARAMS   0x8B
+#define OPCODE_SET_PKT_PARAMS          0x8C
+#define OPCODE_SET_BUFFER_BASE_ADDRESS 0x8F
+#define OPCODE_SET_LORA_SYMB_NUM_TIMEOUT  0xA0
+#define OPCODE_GET_STATUS              0xC0
+#define OPCODE_SET_FS                  0xC1
+#define OPCODE_SET_CAD                 0xC5
+
+// Response header sizes (opcode, parameters and status) of the read commands.
+#define HEADER_SIZE_READ_REGISTER      4
+#define HEADER_SIZE_READ_BUFFER        3
+#define HEADER_SIZE_READ_CMD           2
+
+// IRQ flags.
+#define IRQ_TX_DONE                    0x0001
+#define IRQ_RX_DONE                    0x0002
+#define IRQ_PREAMBLE_DETECTED          0x0004
+#define IRQ_HEADER_VALID               0x0010
+#define IRQ_CAD_DONE                   0x0080
+#define IRQ_TIMEOUT                    0x0200
+
+// Registers.
+#define REG_FIRST                      0x0600
+#define REG_LAST                       0x09FF
+#define REG_LORA_SYNC_WORD_MSB         0x0740
+#define REG_LORA_SYNC_WORD_LSB         0x0741
+#define REG_RANDOM_NUMBER_GEN_FIRST    0x0819
+#define REG_RANDOM_NUMBER_GEN_LAST     0x081C
+
+#define PKT_TYPE_LORA                  0x01
+
+// Timeouts are in steps of 15.625 us.
+#define RX_TIMEOUT_CONTINUOUS          0xFFFFFF
+#define TIMEOUT_STEPS_TO_US(steps)     (((uint64_t) (steps) * 15625) / 1000)
+
+// Time of the packets that are not LoRa.
+#define NON_LORA_PACKET_US             10000
+
+// Noise floor returned by GET_RSSI_INST.
+#define NOISE_FLOOR_DBM                -120
+
+#define DATA_BUFFER_SIZE               256
+#define TRANSFER_MAX_SIZE              (HEADER_SIZE_READ_BUFFER + DATA_BUFFER_SIZE)
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+// Chip modes, as encoded in the status byte.
+typedef enum
+{
+   EMUL_MODE_SLEEP      = 0,
+   EMUL_MODE_STBY_RC    = 2,
+   EMUL_MODE_STBY_XOSC  = 3,
+   EMUL_MODE_FS         = 4,
+   EMUL_MODE_RX         = 5,
+   EMUL_MODE_TX         = 6,
+   EMUL_MODE_CAD        = 7,     // Reported as RX.
+} Sx126xEmulMode_t;
+
+typedef struct Sx126xEmulCfg_s
+{
+   struct gpio_dt_spec  gpioBusy;
+   struct gpio_dt_spec  gpioDio1;
+} Sx126xEmulCfg_t;
+
+typedef struct Sx126xEmulData_s
+{
+   const struct emul   *target;
+   struct k_spinlock    lock;
+   struct k_timer       busyTimer;
+   struct k_timer       eventTimer;
+
+   Sx126xEmulMode_t     mode;
+   bool                 rxContinuous;
+   uint8_t              pktType;
+   uint8_t              modParams[4];    // SF, BW, CR, LDRO.
+   uint8_t              pktParams[6];    // Preamble (2), header type, length, CRC, IQ.
+   uint8_t              symbNumTimeout;
+   uint32_t             rfFreqHz;
+
+   uint16_t             irqStatus;
+   uint16_t             irqMask;
+   uint16_t             dio1Mask;
+
+   uint8_t              registers[REG_LAST - REG_FIRST + 1];
+   uint8_t              buffer[DATA_BUFFER_SIZE];
+   uint8_t              txBase;
+   uint8_t              rxBase;
+   uint8_t              rxLength;
+   int16_t              rxLastRssi;
+   int8_t               rxLastSnr;
+
+   // Packet queued by sx126x_emul_inject_rx().
+   bool                 injected;
+   uint8_t              injectedPayload[DATA_BUFFER_SIZE];
+   uint8_t              injectedSize;
+   int16_t              injectedRssi;
+   int8_t               injectedSnr;
+
+   sx126x_emul_tx_cb_t  txCallback;
+   void                *txUserData;
+
+   uint32_t             busyUs;
+   uint32_t             rxDelayUs;
+} Sx126xEmulData_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static void Sx126xEmulCommand(Sx126xEmulData_t *data, const uint8_t *tx, uint8_t *rx, size_t length);
+static void Sx126xEmulStartEvent(Sx126xEmulData_t *data, uint32_t delayUs);
+static void Sx126xEmulEventHandler(struct k_timer *timer);
+static void Sx126xEmulBusyHandler(struct k_timer *timer);
+static void Sx126xEmulUpdateDio1(const struct emul *target);
+static uint32_t Sx126xEmulSymbolUs(const Sx126xEmulData_t *data);
+static uint32_t Sx126xEmulTimeOnAirUs(const Sx126xEmulData_t *data, uint8_t size);
+static uint8_t Sx126xEmulStatus(const Sx126xEmulData_t *data);
+static size_t Sx126xEmulBufSetLength(const struct spi_buf_set *bufs);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+const struct emul *sx126x_emul_get(void)
+{
+#if DT_NODE_HAS_STATUS(DT_ALIAS(lora0), okay)
+   return EMUL_DT_GET(DT_ALIAS(lora0));
+#else
+   return NULL;
+#endif
+}
+
+void sx126x_emul_set_tx_callback(const struct emul *target, sx126x_emul_tx_cb_t callback, void *userData)
+{
+   Sx126xEmulData_t *data = target->data;
+   k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+   data->txCallback = callback;
+   data->txUserData = userData;
+   k_spin_unlock(&data->lock, key);
+}
+
+int sx126x_emul_inject_rx(const struct emul *target, const uint8_t *payload, uint8_t size,
+                          int16_t rssi, int8_t snr)
+{
+   Sx126xEmulData_t *data = target->data;
+   k_spinlock_key_t key = k_spin_lock(&data->lock);
+   int ret = -EBUSY;
+
+   if (!data->injected)
+   {
+      memcpy(data->injectedPayload, payload, size);
+      data->injectedSize = size;
+      data->injectedRssi = rssi;
+      data->injectedSnr  = snr;
+      data->injected     = true;
+      ret = 0;
+
+      // Already listening, receive it now.
+      if (data->mode == EMUL_MODE_RX)
+      {
+         Sx126xEmulStartEvent(data, data->rxDelayUs + Sx126xEmulTimeOnAirUs(data, size));
+      }
+   }
+   k_spin_unlock(&data->lock, key);
+
+   return ret;
+}
+
+void sx126x_emul_set_timing(const struct emul *target, uint32_t busyUs, uint32_t rxDelayUs)
+{
+   Sx126xEmulData_t *data = target->data;
+
+   data->busyUs    = busyUs;
+   data->rxDelayUs = rxDelayUs;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief SPI transaction with the emulated radio.
+ *
+ * @details The TX buffers are gathered in a single command, and the response
+ *          is scattered to the RX buffers. Missing TX bytes are NOPs.
+ */
+static int Sx126xEmulIo(const struct emul *target, const struct spi_config *config,
+                        const struct spi_buf_set *txBufs, const struct spi_buf_set *rxBufs)
+{
+   const Sx126xEmulCfg_t *cfg = target->cfg;
+   Sx126xEmulData_t *data = target->data;
+   uint8_t tx[TRANSFER_MAX_SIZE] = {0};
+   uint8_t rx[TRANSFER_MAX_SIZE];
+   size_t length = MAX(Sx126xEmulBufSetLength(txBufs), Sx126xEmulBufSetLength(rxBufs));
+   size_t offset = 0;
+
+   if (length > sizeof(tx))
+   {
+      LOG_ERR("Transfer too long: %u", (unsigned) length);
+      return -EINVAL;
+   }
+
+   for (size_t i = 0; (txBufs != NULL) && (i < txBufs->count); i++)
+   {
+      if (txBufs->buffers[i].buf != NULL)
+      {
+         memcpy(&tx[offset], txBufs->buffers[i].buf, txBufs->buffers[i].len);
+      }
+      offset += txBufs->buffers[i].len;
+   }
+
+   if (length > 0)
+   {
+      k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+      // Any transaction wakes the radio up.
+      if (data->mode == EMUL_MODE_SLEEP)
+      {
+         data->mode = EMUL_MODE_STBY_RC;
+      }
+
+      memset(rx, Sx126xEmulStatus(data), length);
+      Sx126xEmulCommand(data, tx, rx, length);
+      k_spin_unlock(&data->lock, key);
+   }
+
+   offset = 0;
+   for (size_t i = 0; (rxBufs != NULL) && (i < rxBufs->count); i++)
+   {
+      if (rxBufs->buffers[i].buf != NULL)
+      {
+         memcpy(rxBufs->buffers[i].buf, &rx[offset], rxBufs->buffers[i].len);
+      }
+      offset += rxBufs->buffers[i].len;
+   }
+
+   // The radio is busy while processing the command.
+   if ((length > 0) && (data->busyUs > 0))
+   {
+      gpio_emul_input_set(cfg->gpioBusy.port, cfg->gpioBusy.pin, 1);
+      k_timer_start(&data->busyTimer, K_USEC(data->busyUs), K_NO_WAIT);
+   }
+
+   Sx126xEmulUpdateDio1(target);
+
+   return 0;
+}
+
+/**
+ * @brief Execute a command.
+ *
+ * @param [in] data   Emulator data, locked.
+ * @param [in] tx     Command bytes.
+ * @param [out] rx    Response bytes, initialized with the status.
+ * @param [in] length Transfer length.
+ */
+static void Sx126xEmulCommand(Sx126xEmulData_t *data, const uint8_t *tx, uint8_t *rx, size_t length)
+{
+   const uint8_t *params = &tx[1];
+   const size_t paramsLength = length - 1;
+
+   switch (tx[0])
+   {
+      case OPCODE_SET_SLEEP:
+         k_timer_stop(&data->eventTimer);
+         data->mode = EMUL_MODE_SLEEP;
+         break;
+
+      case OPCODE_SET_STANDBY:
+         k_timer_stop(&data->eventTimer);
+         data->mode = (params[0] != 0) ? EMUL_MODE_STBY_XOSC : EMUL_MODE_STBY_RC;
+         break;
+
+      case OPCODE_SET_FS:
+         k_timer_stop(&data->eventTimer);
+         data->mode = EMUL_MODE_FS;
+         break;
+
+      case OPCODE_SET_TX:
+         data->mode = EMUL_MODE_TX;
+         Sx126xEmulStartEvent(data, Sx126xEmulTimeOnAirUs(data, data->pktParams[3]));
+         break;
+
+      case OPCODE_SET_RX:
+      {
+         const uint32_t timeout = ((uint32_t) params[0] << 16) | ((uint32_t) params[1] << 8) | params[2];
+         uint32_t delayUs = 0;
+
+         data->mode = EMUL_MODE_RX;
+         data->rxContinuous = (timeout == RX_TIMEOUT_CONTINUOUS);
+
+         if (data->injected)
+         {
+            delayUs = data->rxDelayUs + Sx126xEmulTimeOnAirUs(data, data->injectedSize);
+         }
+         else if ((timeout != 0) && !data->rxContinuous)
+         {
+            delayUs = (uint32_t) TIMEOUT_STEPS_TO_US(timeout);
+         }
+         else if ((timeout == 0) && (data->symbNumTimeout > 0))
+         {
+            delayUs = data->symbNumTimeout * Sx126xEmulSymbolUs(data);
+         }
+
+         if (delayUs > 0)
+         {
+            Sx126xEmulStartEvent(data, delayUs);
+         }
+         else
+         {
+            k_timer_stop(&data->eventTimer);
+         }
+         break;
+      }
+
+      case OPCODE_SET_CAD:
+         data->mode = EMUL_MODE_CAD;
+         Sx126xEmulStartEvent(data, 2 * Sx126xEmulSymbolUs(data));
+         break;
+
+      case OPCODE_SET_PKT_TYPE:
+         data->pktType = params[0];
+         break;
+
+      case OPCODE_GET_PKT_TYPE:
+         if (length > HEADER_SIZE_READ_CMD)
+         {
+            rx[HEADER_SIZE_READ_CMD] = data->pktType;
+         }
+         break;
+
+      case OPCODE_SET_RF_FREQUENCY:
+      {
+         const uint32_t rfFreq = sys_get_be32(params);
+
+         data->rfFreqHz = (uint32_t) (((uint64_t) rfFreq * 32000000) >> 25);
+         break;
+      }
+
+      case OPCODE_SET_MODULATION_PARAMS:
+         memcpy(data->modParams, params, MIN(paramsLength, sizeof(data->modParams)));
+         break;
+
+      case OPCODE_SET_PKT_PARAMS:
+         memcpy(data->pktParams, params, MIN(paramsLength, sizeof(data->pktParams)));
+         break;
+
+      case OPCODE_SET_LORA_SYMB_NUM_TIMEOUT:
+         data->symbNumTimeout = params[0];
+         break;
+
+      case OPCODE_SET_BUFFER_BASE_ADDRESS:
+         data->txBase = params[0];
+         data->rxBase = params[1];
+         break;
+
+      case OPCODE_SET_DIO_IRQ_PARAMS:
+         data->irqMask  = sys_get_be16(&params[0]);
+         data->dio1Mask = sys_get_be16(&params[2]);
+         break;
+
+      case OPCODE_GET_IRQ_STATUS:
+         if (length >= HEADER_SIZE_READ_CMD + 2)
+         {
+            sys_put_be16(data->irqStatus, &rx[HEADER_SIZE_READ_CMD]);
+         }
+         break;
+
+      case OPCODE_CLR_IRQ_STATUS:
+         data->irqStatus &= ~sys_get_be16(params);
+         break;
+
+      case OPCODE_GET_RX_BUFFER_STATUS:
+         if (length >= HEADER_SIZE_READ_CMD + 2)
+         {
+            rx[HEADER_SIZE_READ_CMD]     = data->rxLength;
+            rx[HEADER_SIZE_READ_CMD + 1] = data->rxBase;
+         }
+         break;
+
+      case OPCODE_GET_PKT_STATUS:
+         if (length >= HEADER_SIZE_READ_CMD + 3)
+         {
+            rx[HEADER_SIZE_READ_CMD]     = (uint8_t) (-data->rxLastRssi * 2);
+            rx[HEADER_SIZE_READ_CMD + 1] = (uint8_t) (data->rxLastSnr * 4);
+            rx[HEADER_SIZE_READ_CMD + 2] = (uint8_t) (-data->rxLastRssi * 2);
+         }
+         break;
+
+      case OPCODE_GET_RSSI_INST:
+         if (length > HEADER_SIZE_READ_CMD)
+         {
+            rx[HEADER_SIZE_READ_CMD] = (uint8_t) (-NOISE_FLOOR_DBM * 2);
+         }
+         break;
+
+      case OPCODE_GET_STATS:
+      case OPCODE_GET_DEVICE_ERRORS:
+         memset(&rx[HEADER_SIZE_READ_CMD], 0, length - MIN(length, HEADER_SIZE_READ_CMD));
+         break;
+
+      case OPCODE_GET_STATUS:
+         // Every byte is the status.
+         break;
+
+      case OPCODE_WRITE_REGISTER:
+      {
+         const uint16_t address = sys_get_be16(params);
+
+         for (size_t i = 3; i < length; i++)
+         {
+            if ((address + i - 3 >= REG_FIRST) && (address + i - 3 <= REG_LAST))
+            {
+               data->registers[address + i - 3 - REG_FIRST] = tx[i];
+            }
+         }
+         break;
+      }
+
+      case OPCODE_READ_REGISTER:
+      {
+         const uint16_t address = sys_get_be16(params);
+
+         for (size_t i = HEADER_SIZE_READ_REGISTER; i < length; i++)
+         {
+            const uint16_t reg = address + i - HEADER_SIZE_READ_REGISTER;
+
+            if ((reg >= REG_RANDOM_NUMBER_GEN_FIRST) && (reg <= REG_RANDOM_NUMBER_GEN_LAST))
+            {
+               rx[i] = (uint8_t) sys_rand32_get();
+            }
+            else if ((reg >= REG_FIRST) && (reg <= REG_LAST))
+            {
+               rx[i] = data->registers[reg - REG_FIRST];
+            }
+            else
+            {
+               rx[i] = 0;
+            }
+         }
+         break;
+      }
+
+      case OPCODE_WRITE_BUFFER:
+         for (size_t i = 2; i < length; i++)
+         {
+            data->buffer[(uint8_t) (params[0] + i - 2)] = tx[i];
+         }
+         break;
+
+      case OPCODE_READ_BUFFER:
+         for (size_t i = HEADER_SIZE_READ_BUFFER; i < length; i++)
+         {
+            rx[i] = data->buffer[(uint8_t) (params[0] + i - HEADER_SIZE_READ_BUFFER)];
+         }
+         break;
+
+      default:
+         // Other commands (calibration, PA, regulator, DIO2/DIO3...) have no effect.
+         break;
+   }
+}
+
+/**
+ * @brief Schedule the end of a TX, RX or CAD.
+ */
+static void Sx126xEmulStartEvent(Sx126xEmulData_t *data, uint32_t delayUs)
+{
+   k_timer_start(&data->eventTimer, K_USEC(MAX(delayUs, 1)), K_NO_WAIT);
+}
+
+/**
+ * @brief End of a TX, RX or CAD: raise the IRQ and go back to standby.
+ */
+static void Sx126xEmulEventHandler(struct k_timer *timer)
+{
+   Sx126xEmulData_t *data = CONTAINER_OF(timer, Sx126xEmulData_t, eventTimer);
+   sx126x_emul_tx_cb_t txCallback = NULL;
+   uint8_t txPayload[DATA_BUFFER_SIZE];
+   uint8_t txSize = 0;
+   uint16_t irq = 0;
+
+   k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+   switch (data->mode)
+   {
+      case EMUL_MODE_TX:
+         irq = IRQ_TX_DONE;
+         txSize = data->pktParams[3];
+         for (uint16_t i = 0; i < txSize; i++)
+         {
+            txPayload[i] = data->buffer[(uint8_t) (data->txBase + i)];
+         }
+         txCallback = data->txCallback;
+         data->mode = EMUL_MODE_STBY_RC;
+         break;
+
+      case EMUL_MODE_RX:
+         if (data->injected)
+         {
+            irq = IRQ_PREAMBLE_DETECTED | IRQ_HEADER_VALID | IRQ_RX_DONE;
+            for (uint16_t i = 0; i < data->injectedSize; i++)
+            {
+               data->buffer[(uint8_t) (data->rxBase + i)] = data->injectedPayload[i];
+            }
+            data->rxLength   = data->injectedSize;
+            data->rxLastRssi = data->injectedRssi;
+            data->rxLastSnr  = data->injectedSnr;
+            data->injected   = false;
+         }
+         else
+         {
+            irq = IRQ_TIMEOUT;
+         }
+         if (!data->rxContinuous)
+         {
+            data->mode = EMUL_MODE_STBY_RC;
+         }
+         break;
+
+      case EMUL_MODE_CAD:
+         irq = IRQ_CAD_DONE;
+         data->mode = EMUL_MODE_STBY_RC;
+         break;
+
+      default:
+         break;
+   }
+
+   data->irqStatus |= irq & data->irqMask;
+   k_spin_unlock(&data->lock, key);
+
+   Sx126xEmulUpdateDio1(data->target);
+
+   if (txCallback != NULL)
+   {
+      txCallback(data->target, txPayload, txSize, data->rfFreqHz, data->txUserData);
+   }
+}
+
+/**
+ * @brief End of the command processing.
+ */
+static void Sx126xEmulBusyHandler(struct k_timer *timer)
+{
+   Sx126xEmulData_t *data = CONTAINER_OF(timer, Sx126xEmulData_t, busyTimer);
+   const Sx126xEmulCfg_t *cfg = data->target->cfg;
+
+   gpio_emul_input_set(cfg->gpioBusy.port, cfg->gpioBusy.pin, 0);
+}
+
+/**
+ * @brief DIO1 is high as long as an IRQ routed to DIO1 is set.
+ */
+static void Sx126xEmulUpdateDio1(const struct emul *target)
+{
+   const Sx126xEmulCfg_t *cfg = target->cfg;
+   Sx126xEmulData_t *data = target->data;
+
+   gpio_emul_input_set(cfg->gpioDio1.port, cfg->gpioDio1.pin, (data->irqStatus & data->dio1Mask) != 0);
+}
+
+/**
+ * @brief LoRa symbol time.
+ */
+static uint32_t Sx126xEmulSymbolUs(const Sx126xEmulData_t *data)
+{
+   // Bandwidth in Hz, indexed by the SX126x bandwidth code.
+   static const uint32_t bandwidths[] =
+   {
+      7810, 15630, 31250, 62500, 125000, 250000, 500000, 0, 10420, 20830, 41670
+   };
+   const uint8_t sf = CLAMP(data->modParams[0], 5, 12);
+   uint32_t bandwidth = 125000;
+
+   if ((data->modParams[1] < ARRAY_SIZE(bandwidths)) && (bandwidths[data->modParams[1]] != 0))
+   {
+      bandwidth = bandwidths[data->modParams[1]];
+   }
+
+   return (uint32_t) ((1000000ULL << sf) / bandwidth);
+}
+
+/**
+ * @brief LoRa time on air, from the SX126x datasheet.
+ */
+static uint32_t Sx126xEmulTimeOnAirUs(const Sx126xEmulData_t *data, uint8_t size)
+{
+   if (data->pktType != PKT_TYPE_LORA)
+   {
+      return NON_LORA_PACKET_US;
+   }
+
+   const int32_t sf       = CLAMP(data->modParams[0], 5, 12);
+   const int32_t cr       = CLAMP(data->modParams[2], 1, 4);
+   const int32_t ldro     = (data->modParams[3] != 0) ? 1 : 0;
+   const int32_t preamble = sys_get_be16(&data->pktParams[0]);
+   const int32_t implicit = (data->pktParams[2] != 0) ? 1 : 0;
+   const int32_t crc      = (data->pktParams[4] != 0) ? 1 : 0;
+   const uint32_t symbolUs = Sx126xEmulSymbolUs(data);
+
+   const int32_t num = 8 * size + 16 * crc - 4 * sf + 28 - 20 * implicit;
+   const int32_t den = 4 * (sf - 2 * ldro);
+   const int32_t symbols = 8 + MAX(DIV_ROUND_UP(MAX(num, 0), den) * (cr + 4), 0);
+
+   return (((uint32_t) preamble * 4 + 17) * symbolUs) / 4 + (uint32_t) symbols * symbolUs;
+}
+
+/**
+ * @brief Status byte returned on each command byte.
+ */
+static uint8_t Sx126xEmulStatus(const Sx126xEmulData_t *data)
+{
+   const Sx126xEmulMode_t mode = (data->mode == EMUL_MODE_CAD) ? EMUL_MODE_RX : data->mode;
+
+   return (uint8_t) (mode << 4);
+}
+
+static size_t Sx126xEmulBufSetLength(const struct spi_buf_set *bufs)
+{
+   size_t length = 0;
+
+   for (size_t i = 0; (bufs != NULL) && (i < bufs->count); i++)
+   {
+      length += bufs->buffers[i].len;
+   }
+   return length;
+}
+
+static int Sx126xEmulInit(const struct emul *target, const struct device *parent)
+{
+   Sx126xEmulData_t *data = target->data;
+
+   ARG_UNUSED(parent);
+
+   data->target    = target;
+   data->mode      = EMUL_MODE_STBY_RC;
+   data->busyUs    = CONFIG_LBM_RADIO_HAL_EMUL_BUSY_US;
+   data->rxDelayUs = CONFIG_LBM_RADIO_HAL_EMUL_RX_DELAY_US;
+   data->registers[REG_LORA_SYNC_WORD_MSB - REG_FIRST] = 0x14;
+   data->registers[REG_LORA_SYNC_WORD_LSB - REG_FIRST] = 0x24;
+
+   k_timer_init(&data->busyTimer, Sx126xEmulBusyHandler, NULL);
+   k_timer_init(&data->eventTimer, Sx126xEmulEventHandler, NULL);
+
+   return 0;
+}
+
+static const struct spi_emul_api sx126xEmulApi =
+{
+   .io = Sx126xEmulIo,
+};
+
+// The emulator is attached to a device: define an empty one when there is no
+// Zephyr driver for the radio.
+#define SX126X_EMUL_DEVICE(n)                                                    \
+   DEVICE_DT_INST_DEFINE(n, NULL, NULL, NULL, NULL, POST_KERNEL,                 \
+                         CONFIG_KERNEL_INIT_PRIORITY_DEVICE, NULL);
+
+#define SX126X_EMUL(n)                                                           \
+   COND_CODE_1(CONFIG_LORA_SX126X, (), (SX126X_EMUL_DEVICE(n)))                  \
+   static Sx126xEmulData_t sx126xEmulData##n;                                    \
+   static const Sx126xEmulCfg_t sx126xEmulCfg##n =                               \
+   {                                                                             \
+      .gpioBusy = GPIO_DT_SPEC_INST_GET(n, busy_gpios),                          \
+      .gpioDio1 = GPIO_DT_SPEC_INST_GET(n, dio1_gpios),                          \
+   };                                                                            \
+   EMUL_DT_INST_DEFINE(n, Sx126xEmulInit, &sx126xEmulData##n, &sx126xEmulCfg##n, \
+                       &sx126xEmulApi, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(SX126X_EMUL)
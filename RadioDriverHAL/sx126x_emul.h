@@ -0,0 +1,104 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Emulated SX1262 radio, as a Zephyr SPI emulator.
+*
+* @details  The emulator implements the SX126x commands used by the radio HAL:
+*           registers, data buffer, IRQ status and DIO1/BUSY lines (through the
+*           emulated GPIO controller). TX and RX complete after the LoRa time
+*           on air of the packet.
+*
+*           There is no RF: a transmitted packet is passed to the TX callback,
+*           and a packet injected with sx126x_emul_inject_rx() is received by
+*           the next RX. A network stand-in can be built on these two hooks.
+******************************************************************************/
+
+#ifndef SX126X_EMUL_H
+#define SX126X_EMUL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <zephyr/drivers/emul.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Callback called when the emulated radio completes a transmission.
+ *
+ * @remark Called from the timer expiry (interrupt) context.
+ *
+ * @param [in] target   Emulated radio.
+ * @param [in] payload  Transmitted payload.
+ * @param [in] size     Payload size.
+ * @param [in] freqHz   RF frequency.
+ * @param [in] userData User data given to sx126x_emul_set_tx_callback().
+ */
+typedef void (*sx126x_emul_tx_cb_t)(const struct emul *target, const uint8_t *payload, uint8_t size,
+                                    uint32_t freqHz, void *userData);
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Get the emulated radio of the lora0 alias.
+ *
+ * @return Emulated radio, or NULL.
+ */
+const struct emul *sx126x_emul_get(void);
+
+/**
+ * @brief Set the callback called on each transmitted packet.
+ *
+ * @param [in] target   Emulated radio.
+ * @param [in] callback Callback, or NULL.
+ * @param [in] userData User data passed to the callback.
+ */
+void sx126x_emul_set_tx_callback(const struct emul *target, sx126x_emul_tx_cb_t callback, void *userData);
+
+/**
+ * @brief Queue a packet for the next reception.
+ *
+ * @param [in] target  Emulated radio.
+ * @param [in] payload Packet payload.
+ * @param [in] size    Payload size.
+ * @param [in] rssi    Packet RSSI in dBm.
+ * @param [in] snr     Packet SNR in dB.
+ *
+ * @return 0 on success, -EBUSY if a packet is already queued.
+ */
+int sx126x_emul_inject_rx(const struct emul *target, const uint8_t *payload, uint8_t size,
+                          int16_t rssi, int8_t snr);
+
+/**
+ * @brief Change the emulated timing.
+ *
+ * @param [in] target    Emulated radio.
+ * @param [in] busyUs    BUSY high time after each command, 0 to keep BUSY low.
+ * @param [in] rxDelayUs Extra delay before an injected packet is received.
+ */
+void sx126x_emul_set_timing(const struct emul *target, uint32_t busyUs, uint32_t rxDelayUs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SX126X_EMUL_H
@@ -54,10 +54,13 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include <zephyr/drivers/spi.h>
+#include <zephyr/sys/util.h>
 
 #include "sx126x_hal.h"
 #include "sx126x_hal_context.h"
+#include "sx126x_hal_trace.h"
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(RadioHAL, CONFIG_LBM_LOG_LEVEL);
@@ -68,59 +71,78 @@ LOG_MODULE_REGISTER(RadioHAL, CONFIG_LBM_LOG_LEVEL);
  */
 
 /**
- * Commands Interface
+ * Commands Interface, one X(name, opcode) per command: generates the command
+ * enum and the command names of the logs. Also parsed by
+ * tools/sx126x_trace_decode.py for the command names of the trace.
  */
+#define SX126X_CMD_LIST(X) \
+   /* Operational Modes Functions */ \
+   X(SET_SLEEP,                  0x84) \
+   X(SET_STANDBY,                0x80) \
+   X(SET_FS,                     0xC1) \
+   X(SET_TX,                     0x83) \
+   X(SET_RX,                     0x82) \
+   X(SET_STOP_TIMER_ON_PREAMBLE, 0x9F) \
+   X(SET_RX_DUTY_CYCLE,          0x94) \
+   X(SET_CAD,                    0xC5) \
+   X(SET_TX_CONTINUOUS_WAVE,     0xD1) \
+   X(SET_TX_INFINITE_PREAMBLE,   0xD2) \
+   X(SET_REGULATOR_MODE,         0x96) \
+   X(CALIBRATE,                  0x89) \
+   X(CALIBRATE_IMAGE,            0x98) \
+   X(SET_PA_CFG,                 0x95) \
+   X(SET_RX_TX_FALLBACK_MODE,    0x93) \
+   /* Registers and buffer Access */ \
+   X(WRITE_REGISTER,             0x0D) \
+   X(READ_REGISTER,              0x1D) \
+   X(WRITE_BUFFER,               0x0E) \
+   X(READ_BUFFER,                0x1E) \
+   /* DIO and IRQ Control Functions */ \
+   X(SET_DIO_IRQ_PARAMS,         0x08) \
+   X(GET_IRQ_STATUS,             0x12) \
+   X(CLR_IRQ_STATUS,             0x02) \
+   X(SET_DIO2_AS_RF_SWITCH_CTRL, 0x9D) \
+   X(SET_DIO3_AS_TCXO_CTRL,      0x97) \
+   /* RF Modulation and Packet-Related Functions */ \
+   X(SET_RF_FREQUENCY,           0x86) \
+   X(SET_PKT_TYPE,               0x8A) \
+   X(GET_PKT_TYPE,               0x11) \
+   X(SET_TX_PARAMS,              0x8E) \
+   X(SET_MODULATION_PARAMS,      0x8B) \
+   X(SET_PKT_PARAMS,             0x8C) \
+   X(SET_CAD_PARAMS,             0x88) \
+   X(SET_BUFFER_BASE_ADDRESS,    0x8F) \
+   X(SET_LORA_SYMB_NUM_TIMEOUT,  0xA0) \
+   /* Communication Status Information */ \
+   X(GET_STATUS,                 0xC0) \
+   X(GET_RX_BUFFER_STATUS,       0x13) \
+   X(GET_PKT_STATUS,             0x14) \
+   X(GET_RSSI_INST,              0x15) \
+   X(GET_STATS,                  0x10) \
+   X(RESET_STATS,                0x00) \
+   /* Miscellaneous */ \
+   X(GET_DEVICE_ERRORS,          0x17) \
+   X(CLR_DEVICE_ERRORS,          0x07) \
+   /* Not a command: the start-up after a hardware reset, for the BUSY statistics */ \
+   X(HW_RESET,                   0xFF)
+
+#define SX126X_CMD_ENUM(name, opcode)     SX126X_##name = (opcode),
+#define SX126X_CMD_INDEX(name, opcode)    SX126X_CMD_INDEX_##name,
+#define SX126X_CMD_NAME(name, opcode)     #name,
+#define SX126X_CMD_LOOKUP(name, opcode)   [(opcode)] = SX126X_CMD_INDEX_##name + 1,
+
 typedef enum sx126x_commands_e
 {
-    // Operational Modes Functions
-    SX126X_SET_SLEEP                  = 0x84,
-    SX126X_SET_STANDBY                = 0x80,
-    SX126X_SET_FS                     = 0xC1,
-    SX126X_SET_TX                     = 0x83,
-    SX126X_SET_RX                     = 0x82,
-    SX126X_SET_STOP_TIMER_ON_PREAMBLE = 0x9F,
-    SX126X_SET_RX_DUTY_CYCLE          = 0x94,
-    SX126X_SET_CAD                    = 0xC5,
-    SX126X_SET_TX_CONTINUOUS_WAVE     = 0xD1,
-    SX126X_SET_TX_INFINITE_PREAMBLE   = 0xD2,
-    SX126X_SET_REGULATOR_MODE         = 0x96,
-    SX126X_CALIBRATE                  = 0x89,
-    SX126X_CALIBRATE_IMAGE            = 0x98,
-    SX126X_SET_PA_CFG                 = 0x95,
-    SX126X_SET_RX_TX_FALLBACK_MODE    = 0x93,
-    // Registers and buffer Access
-    SX126X_WRITE_REGISTER = 0x0D,
-    SX126X_READ_REGISTER  = 0x1D,
-    SX126X_WRITE_BUFFER   = 0x0E,
-    SX126X_READ_BUFFER    = 0x1E,
-    // DIO and IRQ Control Functions
-    SX126X_SET_DIO_IRQ_PARAMS         = 0x08,
-    SX126X_GET_IRQ_STATUS             = 0x12,
-    SX126X_CLR_IRQ_STATUS             = 0x02,
-    SX126X_SET_DIO2_AS_RF_SWITCH_CTRL = 0x9D,
-    SX126X_SET_DIO3_AS_TCXO_CTRL      = 0x97,
-    // RF Modulation and Packet-Related Functions
-    SX126X_SET_RF_FREQUENCY          = 0x86,
-    SX126X_SET_PKT_TYPE              = 0x8A,
-    SX126X_GET_PKT_TYPE              = 0x11,
-    SX126X_SET_TX_PARAMS             = 0x8E,
-    SX126X_SET_MODULATION_PARAMS     = 0x8B,
-    SX126X_SET_PKT_PARAMS            = 0x8C,
-    SX126X_SET_CAD_PARAMS            = 0x88,
-    SX126X_SET_BUFFER_BASE_ADDRESS   = 0x8F,
-    SX126X_SET_LORA_SYMB_NUM_TIMEOUT = 0xA0,
-    // Communication Status Information
-    SX126X_GET_STATUS           = 0xC0,
-    SX126X_GET_RX_BUFFER_STATUS = 0x13,
-    SX126X_GET_PKT_STATUS       = 0x14,
-    SX126X_GET_RSSI_INST        = 0x15,
-    SX126X_GET_STATS            = 0x10,
-    SX126X_RESET_STATS          = 0x00,
-    // Miscellaneous
-    SX126X_GET_DEVICE_ERRORS = 0x17,
-    SX126X_CLR_DEVICE_ERRORS = 0x07,
+   SX126X_CMD_LIST(SX126X_CMD_ENUM)
 } sx126x_commands_t;
 
+// Position of each command in the list, for the name lookup.
+enum
+{
+   SX126X_CMD_LIST(SX126X_CMD_INDEX)
+   SX126X_CMD_COUNT
+};
+
 
 /*
  * -----------------------------------------------------------------------------
@@ -130,6 +152,10 @@ typedef enum sx126x_commands_e
 // SX126X_SET_SLEEP command.
 #define OPCODE_SET_SLEEP      0x84
 #define CMD_SIZE_SET_SLEEP    2
+#define SLEEP_CFG_WARM_START  0x04
+
+// Maximum time for BUSY to rise once the reset is released.
+#define RESET_BUSY_RISE_US    100
 
 // SX126X_READ_REGISTER command opcode and status size.
 #define OPCODE_READ_REGISTER        0x1D
@@ -142,32 +168,85 @@ typedef enum sx126x_commands_e
 // Status size of other read/get commands.
 #define STATUS_SIZE_READ_CMD        2
 
+// Number of logarithmic buckets in the BUSY wait-time histogram.
+// Bucket 0 counts waits under 1 us, bucket n counts waits in [2^(n-1), 2^n) us
+// and the last bucket also counts all longer waits.
+#define BUSY_STATS_BUCKETS          12
+
 
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC TYPES ------------------------------------------------------------
  */
 
-typedef enum
+// BUSY wait-time statistics of one opcode.
+typedef struct BusyStats_s
 {
-   RADIO_SLEEP,
-   RADIO_AWAKE
-} radio_mode_t;
+   uint8_t     opcode;
+   uint32_t    count;
+   uint32_t    maxUs;
+   uint64_t    totalUs;
+   uint32_t    buckets[BUSY_STATS_BUCKETS];
+} BusyStats_t;
 
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE VARIABLES -------------------------------------------------------
  */
 
-static volatile radio_mode_t radio_mode = RADIO_AWAKE;
+// BUSY timeouts and wait-time statistics, of all the radios.
+static uint32_t               busyTimeouts;
+
+#if defined(CONFIG_LBM_RADIO_HAL_BUSY_STATS)
+static struct k_spinlock      busyStatsLock;
+static BusyStats_t            busyStats[CONFIG_LBM_RADIO_HAL_BUSY_STATS_OPCODES];
+static uint32_t               busyStatsUsed;
+static uint32_t               busyStatsDropped;
+#endif
+
+#if defined(CONFIG_LBM_RADIO_HAL_SHADOW)
+// Idempotent configuration commands. Writing the same parameters twice has no effect,
+// so a write identical to the last one is skipped.
+static const uint8_t          shadowOpcodes[] = {
+   SX126X_SET_PKT_TYPE,
+   SX126X_SET_RF_FREQUENCY,
+   SX126X_SET_MODULATION_PARAMS,
+   SX126X_SET_PKT_PARAMS,
+   SX126X_SET_DIO_IRQ_PARAMS,
+   SX126X_SET_TX_PARAMS,
+   SX126X_SET_BUFFER_BASE_ADDRESS,
+   SX126X_SET_CAD_PARAMS,
+   SX126X_SET_LORA_SYMB_NUM_TIMEOUT,
+   SX126X_SET_PA_CFG,
+   SX126X_SET_REGULATOR_MODE,
+   SX126X_SET_DIO2_AS_RF_SWITCH_CTRL,
+   SX126X_SET_RX_TX_FALLBACK_MODE,
+   SX126X_SET_STOP_TIMER_ON_PREAMBLE,
+};
+BUILD_ASSERT(ARRAY_SIZE(shadowOpcodes) == SX126X_HAL_SHADOW_ENTRIES, "Shadow table size mismatch");
+#endif
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
  */
 
-static void Sx126xHalWaitOnBusy(const struct gpio_dt_spec *gpioBusy);
-static void Sx126xHalCheckDeviceReady(const sx126x_hal_context_t *sx126xContext);
-char *Sx126xCmdName(sx126x_commands_t cmd);
+static sx126x_hal_status_t Sx126xHalWaitOnBusy(const sx126x_hal_context_t *sx126xContext);
+static sx126x_hal_status_t Sx126xHalSleepOnBusy(const sx126x_hal_context_t *sx126xContext);
+static bool Sx126xHalInitBusyIrq(const sx126x_hal_context_t *sx126xContext);
+static void Sx126xHalBusyHandler(const struct device *port, struct gpio_callback *busyCallback, uint32_t pins);
+static void Sx126xHalBusyStatsRecord(uint8_t opcode, uint32_t waitUs);
+static void Sx126xHalWakeStatsRecord(sx126x_hal_state_t *state, sx126x_hal_wake_kind_t kind, uint32_t latencyUs);
+static bool Sx126xHalShadowMatch(sx126x_hal_state_t *state, const uint8_t *command, const uint16_t command_length,
+                                 const uint8_t *data, const uint16_t data_length);
+static void Sx126xHalShadowUpdate(sx126x_hal_state_t *state, const uint8_t *command, const uint16_t command_length,
+                                  const uint8_t *data, const uint16_t data_length);
+static void Sx126xHalShadowInvalidate(sx126x_hal_state_t *state);
+static sx126x_hal_status_t Sx126xHalCheckDeviceReady(const sx126x_hal_context_t *sx126xContext);
+static void Sx126xHalCommandSent(const sx126x_hal_context_t *sx126xContext, const uint8_t *command,
+                                 const uint16_t command_length, const uint8_t *data, const uint16_t data_length);
+static uint16_t Sx126xHalReadStatusSize(const uint8_t opcode);
+const char *Sx126xCmdName(sx126x_commands_t cmd);
 
 /*
  * -----------------------------------------------------------------------------
@@ -190,6 +269,8 @@ sx126x_hal_status_t sx126x_hal_write(const void *context, const uint8_t *command
 
 {
    const sx126x_hal_context_t *sx126xContext = (const sx126x_hal_context_t *) context;
+   sx126x_hal_state_t *state = sx126xContext->state;
+   const uint32_t startCycles = k_cycle_get_32();
    int ret;
 
    struct spi_buf      txBuf[2];
@@ -202,13 +283,21 @@ sx126x_hal_status_t sx126x_hal_write(const void *context, const uint8_t *command
    txBuffers.buffers = txBuf;
    txBuffers.count = 2;
 
-   // Wait for readiness.
-   Sx126xHalCheckDeviceReady(sx126xContext);
+   // Skip a configuration command identical to the last one written.
+   if (Sx126xHalShadowMatch(state, command, command_length, data, data_length))
+   {
+      state->shadowElidedCmds++;
+      state->shadowElidedBytes += command_length + data_length;
+      Sx126xHalTraceRecord(startCycles, SX126X_TRACE_FLAG_ELIDED, 0, command, command_length, data, data_length);
+      return SX126X_HAL_STATUS_OK;
+   }
 
-   LOG_HEXDUMP_DBG(txBuffers.buffers[0].buf, txBuffers.buffers[0].len, Sx126xCmdName(command[0]));
-   if (txBuffers.buffers[1].buf != 0)
+   // Wait for readiness.
+   if (Sx126xHalCheckDeviceReady(sx126xContext) != SX126X_HAL_STATUS_OK)
    {
-      LOG_HEXDUMP_DBG(txBuffers.buffers[1].buf, txBuffers.buffers[1].len, "Write data:");
+      Sx126xHalTraceRecord(startCycles, SX126X_TRACE_FLAG_ERROR, state->busyLastWaitUs,
+                           command, command_length, data, data_length);
+      return SX126X_HAL_STATUS_ERROR;
    }
 
    // Write the command and data to the SX126X.
@@ -217,14 +306,14 @@ sx126x_hal_status_t sx126x_hal_write(const void *context, const uint8_t *command
    if (ret < 0)
    {
       LOG_ERR("SPI write error: %d", ret);
+      Sx126xHalShadowInvalidate(state);
+      Sx126xHalTraceRecord(startCycles, SX126X_TRACE_FLAG_ERROR, state->busyLastWaitUs,
+                           command, command_length, data, data_length);
       return SX126X_HAL_STATUS_ERROR;
    }
 
-   // Check whether the command is a sleep command to keep the state up to date.
-   if ((command[0] == OPCODE_SET_SLEEP) && (command_length == CMD_SIZE_SET_SLEEP))
-   {
-      radio_mode = RADIO_SLEEP;
-   }
+   Sx126xHalCommandSent(sx126xContext, command, command_length, data, data_length);
+   Sx126xHalTraceRecord(startCycles, 0, state->busyLastWaitUs, command, command_length, data, data_length);
 
    return SX126X_HAL_STATUS_OK;
 }
@@ -244,6 +333,8 @@ sx126x_hal_status_t sx126x_hal_read(const void *context, const uint8_t *command,
                                     uint8_t *data, const uint16_t data_length)
 {
    const sx126x_hal_context_t *sx126xContext = (const sx126x_hal_context_t *) context;
+   const sx126x_hal_state_t *state = sx126xContext->state;
+   const uint32_t startCycles = k_cycle_get_32();
    int ret;
 
    struct spi_buf      txBuf[2];
@@ -259,24 +350,8 @@ sx126x_hal_status_t sx126x_hal_read(const void *context, const uint8_t *command,
    txBuffers.buffers = txBuf;
    txBuffers.count = 2;
 
-   if (command[0] == OPCODE_READ_REGISTER)
-   {
-      rxBuf[0].buf = rxStatus;
-      rxBuf[0].len = STATUS_SIZE_READ_REGISTER;
-      LOG_HEXDUMP_DBG(txBuffers.buffers[0].buf, txBuffers.buffers[0].len, "READ_REGISTER:");
-   }
-   else if (command[0] == OPCODE_READ_BUFFER)
-   {
-      rxBuf[0].buf = rxStatus;
-      rxBuf[0].len = STATUS_SIZE_READ_BUFFER;
-      LOG_HEXDUMP_DBG(txBuffers.buffers[0].buf, txBuffers.buffers[0].len, "READ_BUFFER:");
-   }
-   else  // Other read command.
-   {
-      rxBuf[0].buf = rxStatus;
-      rxBuf[0].len = STATUS_SIZE_READ_CMD;
-      LOG_HEXDUMP_DBG(txBuffers.buffers[0].buf, txBuffers.buffers[0].len, Sx126xCmdName(command[0]));
-   }
+   rxBuf[0].buf = rxStatus;
+   rxBuf[0].len = Sx126xHalReadStatusSize(command[0]);
 
    rxBuf[1].buf = (void *) data;
    rxBuf[1].len = data_length;
@@ -284,7 +359,12 @@ sx126x_hal_status_t sx126x_hal_read(const void *context, const uint8_t *command,
    rxBuffers.count = 2;
 
    // Wait for readiness.
-   Sx126xHalCheckDeviceReady(sx126xContext);
+   if (Sx126xHalCheckDeviceReady(sx126xContext) != SX126X_HAL_STATUS_OK)
+   {
+      Sx126xHalTraceRecord(startCycles, SX126X_TRACE_FLAG_READ | SX126X_TRACE_FLAG_ERROR, state->busyLastWaitUs,
+                           command, command_length, NULL, data_length);
+      return SX126X_HAL_STATUS_ERROR;
+   }
 
    // Write the command and read the data from the SX126X.
    ret = spi_transceive_dt(&sx126xContext->spiSpec, &txBuffers, &rxBuffers);
@@ -292,11 +372,14 @@ sx126x_hal_status_t sx126x_hal_read(const void *context, const uint8_t *command,
    if (ret < 0)
    {
       LOG_ERR("SPI read error: %d", ret);
+      Sx126xHalTraceRecord(startCycles, SX126X_TRACE_FLAG_READ | SX126X_TRACE_FLAG_ERROR, state->busyLastWaitUs,
+                           command, command_length, NULL, data_length);
       return SX126X_HAL_STATUS_ERROR;
    }
 
-   LOG_HEXDUMP_DBG(rxBuf[0].buf, rxBuf[0].len, "Read status:");
-   LOG_HEXDUMP_DBG(rxBuffers.buffers[1].buf, rxBuffers.buffers[1].len, "Read data:");
+   Sx126xHalCommandSent(sx126xContext, command, command_length, NULL, 0);
+   Sx126xHalTraceRecord(startCycles, SX126X_TRACE_FLAG_READ, state->busyLastWaitUs,
+                        command, command_length, data, data_length);
 
    return SX126X_HAL_STATUS_OK;
 }
@@ -311,17 +394,45 @@ sx126x_hal_status_t sx126x_hal_read(const void *context, const uint8_t *command,
 sx126x_hal_status_t sx126x_hal_reset(const void *context)
 {
    const sx126x_hal_context_t *sx126xContext = (const sx126x_hal_context_t *) context;
+   sx126x_hal_status_t status;
+   uint32_t startCycles;
 
    LOG_DBG("Reset sx126x on port %s pin %u", sx126xContext->gpioReset.port->name, sx126xContext->gpioReset.pin);
 
+   // Configure the radio lines on first use.
+   if (!sx126xContext->state->gpioInit)
+   {
+      gpio_pin_configure_dt(&sx126xContext->gpioReset, GPIO_OUTPUT_INACTIVE);
+      gpio_pin_configure_dt(&sx126xContext->gpioBusy, GPIO_INPUT);
+      gpio_pin_configure_dt(&sx126xContext->gpioDio1, GPIO_INPUT);
+      sx126xContext->state->gpioInit = true;
+   }
+
    gpio_pin_set_dt(&sx126xContext->gpioReset, 1);
-   k_sleep(K_USEC(2000));
+   k_sleep(K_USEC(CONFIG_LBM_RADIO_HAL_RESET_PULSE_US));
    gpio_pin_set_dt(&sx126xContext->gpioReset, 0);
 
+   // The radio raises BUSY while it starts up, then releases it when it is ready
+   // in STDBY_RC. Make sure the start-up began before waiting for its end.
+   startCycles = k_cycle_get_32();
+   while ((gpio_pin_get_dt(&sx126xContext->gpioBusy) == 0) &&
+          ((k_cycle_get_32() - startCycles) < k_us_to_cyc_ceil32(RESET_BUSY_RISE_US)))
+   {
+   }
+
+   // The BUSY wait is the start-up, not the end of the last command sent.
+   sx126xContext->state->busyOpcode = SX126X_HW_RESET;
+   status = Sx126xHalWaitOnBusy(sx126xContext);
+
    // Reset wakes up radio
-   radio_mode = RADIO_AWAKE;
+   sx126xContext->state->radioMode = SX126X_HAL_RADIO_AWAKE;
+   Sx126xHalWakeStatsRecord(sx126xContext->state, SX126X_HAL_WAKE_RESET,
+                            k_cyc_to_us_floor32(k_cycle_get_32() - startCycles));
 
-   return SX126X_HAL_STATUS_OK;
+   // Reset restores the default configuration.
+   Sx126xHalShadowInvalidate(sx126xContext->state);
+
+   return status;
 }
 
 /**
@@ -335,8 +446,135 @@ sx126x_hal_status_t sx126x_hal_wakeup(const void *context)
 {
    const sx126x_hal_context_t *sx126xContext = (const sx126x_hal_context_t *) context;
 
-   Sx126xHalCheckDeviceReady(sx126xContext);
-   return SX126X_HAL_STATUS_OK;
+   return Sx126xHalCheckDeviceReady(sx126xContext);
+}
+
+/**
+ * Log the per-opcode BUSY wait-time histogram.
+ *
+ * @remark Waits are accounted to the opcode sent before the wait, i.e. the
+ *         command that kept the radio busy.
+ */
+void sx126x_hal_busy_stats_log(void)
+{
+#if defined(CONFIG_LBM_RADIO_HAL_BUSY_STATS)
+   LOG_INF("BUSY wait per opcode (buckets: <1us, then powers of 2 up to >=1024us). Timeouts=%u Dropped=%u",
+           busyTimeouts, busyStatsDropped);
+
+   for (uint32_t i = 0; i < busyStatsUsed; i++)
+   {
+      // Copy the entry, another radio may be updating it.
+      k_spinlock_key_t key = k_spin_lock(&busyStatsLock);
+      const BusyStats_t snapshot = busyStats[i];
+      const BusyStats_t *stats = &snapshot;
+      k_spin_unlock(&busyStatsLock, key);
+
+      LOG_INF("%-26s n=%u avg=%u us max=%u us", Sx126xCmdName(stats->opcode), stats->count,
+              (uint32_t) (stats->totalUs / stats->count), stats->maxUs);
+      LOG_INF("   %u %u %u %u %u %u %u %u %u %u %u %u",
+              stats->buckets[0], stats->buckets[1], stats->buckets[2], stats->buckets[3],
+              stats->buckets[4], stats->buckets[5], stats->buckets[6], stats->buckets[7],
+              stats->buckets[8], stats->buckets[9], stats->buckets[10], stats->buckets[11]);
+   }
+#else
+   LOG_INF("BUSY timeouts=%u", busyTimeouts);
+#endif
+}
+
+/**
+ * Get the number of configuration commands skipped because they were identical
+ * to the last ones written, and the number of SPI bytes saved.
+ *
+ * @param [in]  context         Radio implementation parameters.
+ * @param [out] elidedCommands  Number of skipped commands.
+ * @param [out] elidedBytes     Number of skipped command and data bytes.
+ */
+void sx126x_hal_shadow_stats_get(const void *context, uint32_t *elidedCommands, uint32_t *elidedBytes)
+{
+   const sx126x_hal_context_t *sx126xContext = (const sx126x_hal_context_t *) context;
+
+   *elidedCommands = sx126xContext->state->shadowElidedCmds;
+   *elidedBytes = sx126xContext->state->shadowElidedBytes;
+}
+
+/**
+ * Forget the last configuration written, so the next configuration commands are all sent.
+ *
+ * @remark To be called if the radio configuration is changed behind the HAL.
+ *
+ * @param [in] context Radio implementation parameters.
+ */
+void sx126x_hal_shadow_invalidate(const void *context)
+{
+   const sx126x_hal_context_t *sx126xContext = (const sx126x_hal_context_t *) context;
+
+   Sx126xHalShadowInvalidate(sx126xContext->state);
+}
+
+/**
+ * Get the start-up latencies of a radio.
+ *
+ * @param [in]  context Radio implementation parameters.
+ * @param [in]  kind    Warm wake-up, cold wake-up or reset.
+ * @param [out] stats   Start-up latencies of this kind.
+ */
+void sx126x_hal_wake_stats_get(const void *context, sx126x_hal_wake_kind_t kind, sx126x_hal_wake_stats_t *stats)
+{
+   const sx126x_hal_context_t *sx126xContext = (const sx126x_hal_context_t *) context;
+
+   *stats = sx126xContext->state->wakeStats[kind];
+}
+
+/**
+ * Get how a radio was last started.
+ *
+ * @param [in] context Radio implementation parameters.
+ *
+ * @return Warm wake-up, cold wake-up or reset.
+ */
+sx126x_hal_wake_kind_t sx126x_hal_last_wake_get(const void *context)
+{
+   const sx126x_hal_context_t *sx126xContext = (const sx126x_hal_context_t *) context;
+
+   return sx126xContext->state->lastWake;
+}
+
+/**
+ * Log the start-up latencies of a radio.
+ *
+ * @param [in] context Radio implementation parameters.
+ */
+void sx126x_hal_wake_stats_log(const void *context)
+{
+   const sx126x_hal_context_t *sx126xContext = (const sx126x_hal_context_t *) context;
+   static const char * const kindNames[SX126X_HAL_WAKE_KINDS] = { "Warm wake", "Cold wake", "Reset" };
+
+   for (uint32_t kind = 0; kind < SX126X_HAL_WAKE_KINDS; kind++)
+   {
+      const sx126x_hal_wake_stats_t *stats = &sx126xContext->state->wakeStats[kind];
+
+      if (stats->count != 0)
+      {
+         LOG_INF("%-9s n=%u last=%u us avg=%u us max=%u us", kindNames[kind], stats->count, stats->lastUs,
+                 (uint32_t) (stats->totalUs / stats->count), stats->maxUs);
+      }
+   }
+}
+
+/**
+ * Clear the BUSY wait-time histogram.
+ */
+void sx126x_hal_busy_stats_reset(void)
+{
+#if defined(CONFIG_LBM_RADIO_HAL_BUSY_STATS)
+   k_spinlock_key_t key = k_spin_lock(&busyStatsLock);
+
+   memset(busyStats, 0, sizeof(busyStats));
+   busyStatsUsed = 0;
+   busyStatsDropped = 0;
+   k_spin_unlock(&busyStatsLock, key);
+#endif
+   busyTimeouts = 0;
 }
 
 /*
@@ -346,20 +584,290 @@ sx126x_hal_status_t sx126x_hal_wakeup(const void *context)
 
 /**
  * @brief Wait until radio busy pin returns to 0
+ *
+ * Spin on the BUSY line for a short time first, since most commands release it
+ * within a few tens of microseconds, then block on the BUSY falling edge.
+ *
+ * @return SX126X_HAL_STATUS_ERROR if the radio is stuck busy.
  */
-static void Sx126xHalWaitOnBusy(const struct gpio_dt_spec *gpioBusy)
+static sx126x_hal_status_t Sx126xHalWaitOnBusy(const sx126x_hal_context_t *sx126xContext)
 {
-   while (gpio_pin_get_dt(gpioBusy) == 1)
+   const struct gpio_dt_spec *gpioBusy = &sx126xContext->gpioBusy;
+   sx126x_hal_status_t status = SX126X_HAL_STATUS_OK;
+   const uint32_t startCycles = k_cycle_get_32();
+   const uint32_t spinCycles = k_us_to_cyc_ceil32(CONFIG_LBM_RADIO_HAL_BUSY_SPIN_US);
+
+   while ((gpio_pin_get_dt(gpioBusy) == 1) && ((k_cycle_get_32() - startCycles) < spinCycles))
    {
-      k_sleep(K_USEC(1000));
-   };
+   }
+
+   if (gpio_pin_get_dt(gpioBusy) == 1)
+   {
+      status = Sx126xHalSleepOnBusy(sx126xContext);
+   }
+
+   sx126xContext->state->busyLastWaitUs = k_cyc_to_us_floor32(k_cycle_get_32() - startCycles);
+   Sx126xHalBusyStatsRecord(sx126xContext->state->busyOpcode, sx126xContext->state->busyLastWaitUs);
+
+   return status;
 }
 
-static void Sx126xHalCheckDeviceReady(const sx126x_hal_context_t *sx126xContext)
+/**
+ * @brief Block until the BUSY falling-edge interrupt fires or the BUSY timeout expires.
+ *
+ * @remark Falls back to polling if the BUSY interrupt can't be used.
+ */
+static sx126x_hal_status_t Sx126xHalSleepOnBusy(const sx126x_hal_context_t *sx126xContext)
 {
-   if (radio_mode != RADIO_SLEEP)
+   const struct gpio_dt_spec *gpioBusy = &sx126xContext->gpioBusy;
+   sx126x_hal_state_t *state = sx126xContext->state;
+   int rc = -ENODEV;
+
+   if (Sx126xHalInitBusyIrq(sx126xContext))
+   {
+      k_sem_reset(&state->busySem);
+      rc = gpio_pin_interrupt_configure_dt(gpioBusy, GPIO_INT_EDGE_TO_INACTIVE);
+      if (rc == 0)
+      {
+         // BUSY may have been released before the interrupt was armed.
+         if (gpio_pin_get_dt(gpioBusy) == 1)
+         {
+            (void) k_sem_take(&state->busySem, K_MSEC(CONFIG_LBM_RADIO_HAL_BUSY_TIMEOUT_MS));
+         }
+         gpio_pin_interrupt_configure_dt(gpioBusy, GPIO_INT_DISABLE);
+      }
+   }
+
+   if (rc != 0)
    {
-      Sx126xHalWaitOnBusy(&sx126xContext->gpioBusy);
+      const int64_t deadline = k_uptime_get() + CONFIG_LBM_RADIO_HAL_BUSY_TIMEOUT_MS;
+
+      while ((gpio_pin_get_dt(gpioBusy) == 1) && (k_uptime_get() < deadline))
+      {
+         k_sleep(K_USEC(100));
+      }
+   }
+
+   if (gpio_pin_get_dt(gpioBusy) == 1)
+   {
+      busyTimeouts++;
+      LOG_ERR("Radio stuck: BUSY still high %u ms after %s (0x%02x)", CONFIG_LBM_RADIO_HAL_BUSY_TIMEOUT_MS,
+              Sx126xCmdName(state->busyOpcode), state->busyOpcode);
+      return SX126X_HAL_STATUS_ERROR;
+   }
+
+   return SX126X_HAL_STATUS_OK;
+}
+
+/**
+ * @brief Register the BUSY interrupt callback, if necessary.
+ *
+ * @return True if the BUSY interrupt callback is registered.
+ */
+static bool Sx126xHalInitBusyIrq(const sx126x_hal_context_t *sx126xContext)
+{
+   const struct gpio_dt_spec *gpioBusy = &sx126xContext->gpioBusy;
+   sx126x_hal_state_t *state = sx126xContext->state;
+
+   if (!state->busyIrqInit)
+   {
+      k_sem_init(&state->busySem, 0, 1);
+      gpio_init_callback(&state->busyCallbackData, Sx126xHalBusyHandler, BIT(gpioBusy->pin));
+
+      int rc = gpio_add_callback(gpioBusy->port, &state->busyCallbackData);
+      if (rc < 0)
+      {
+         LOG_ERR("Set BUSY interrupt callback error: %d", rc);
+      }
+      else
+      {
+         state->busyIrqInit = true;
+      }
+   }
+   return state->busyIrqInit;
+}
+
+/**
+ * @brief Radio BUSY falling-edge interrupt handling function.
+ *
+ * @param port Device struct for the BUSY GPIO device.
+ * @param busyCallback Original struct gpio_callback owning this handler.
+ * @param pins Mask of pins that triggered the callback handler.
+ */
+static void Sx126xHalBusyHandler(const struct device *port, struct gpio_callback *busyCallback, uint32_t pins)
+{
+   sx126x_hal_state_t *state = CONTAINER_OF(busyCallback, sx126x_hal_state_t, busyCallbackData);
+
+   k_sem_give(&state->busySem);
+}
+
+/**
+ * @brief Account a BUSY wait to the opcode that kept the radio busy.
+ *
+ * @param [in] opcode Opcode of the command sent before the wait.
+ * @param [in] waitUs BUSY wait time in microseconds.
+ */
+static void Sx126xHalBusyStatsRecord(uint8_t opcode, uint32_t waitUs)
+{
+#if defined(CONFIG_LBM_RADIO_HAL_BUSY_STATS)
+   BusyStats_t *stats = NULL;
+   uint32_t bucket = (waitUs == 0) ? 0 : MIN(32 - __builtin_clz(waitUs), BUSY_STATS_BUCKETS - 1);
+   k_spinlock_key_t key = k_spin_lock(&busyStatsLock);
+
+   for (uint32_t i = 0; i < busyStatsUsed; i++)
+   {
+      if (busyStats[i].opcode == opcode)
+      {
+         stats = &busyStats[i];
+         break;
+      }
+   }
+
+   if (stats == NULL)
+   {
+      if (busyStatsUsed >= ARRAY_SIZE(busyStats))
+      {
+         busyStatsDropped++;
+         k_spin_unlock(&busyStatsLock, key);
+         return;
+      }
+      stats = &busyStats[busyStatsUsed++];
+      stats->opcode = opcode;
+   }
+
+   stats->count++;
+   stats->totalUs += waitUs;
+   stats->maxUs = MAX(stats->maxUs, waitUs);
+   stats->buckets[bucket]++;
+   k_spin_unlock(&busyStatsLock, key);
+#endif
+}
+
+/**
+ * @brief Account a radio start-up latency.
+ *
+ * @param [in] state     Radio state.
+ * @param [in] kind      Warm wake-up, cold wake-up or reset.
+ * @param [in] latencyUs Time until the radio released BUSY, in microseconds.
+ */
+static void Sx126xHalWakeStatsRecord(sx126x_hal_state_t *state, sx126x_hal_wake_kind_t kind, uint32_t latencyUs)
+{
+   sx126x_hal_wake_stats_t *stats = &state->wakeStats[kind];
+
+   state->lastWake = kind;
+   stats->count++;
+   stats->lastUs = latencyUs;
+   stats->totalUs += latencyUs;
+   stats->maxUs = MAX(stats->maxUs, latencyUs);
+}
+
+#if defined(CONFIG_LBM_RADIO_HAL_SHADOW)
+/**
+ * @brief Get the shadow entry of a command.
+ *
+ * @return Shadow entry, NULL if the command isn't shadowed.
+ */
+static sx126x_hal_shadow_entry_t *Sx126xHalShadowEntry(sx126x_hal_state_t *state, const uint8_t opcode)
+{
+   for (uint32_t i = 0; i < ARRAY_SIZE(shadowOpcodes); i++)
+   {
+      if (shadowOpcodes[i] == opcode)
+      {
+         return &state->shadow[i];
+      }
+   }
+   return NULL;
+}
+#endif
+
+/**
+ * @brief Check whether a command is shadowed and identical to the last one written.
+ */
+static bool Sx126xHalShadowMatch(sx126x_hal_state_t *state, const uint8_t *command, const uint16_t command_length,
+                                 const uint8_t *data, const uint16_t data_length)
+{
+#if defined(CONFIG_LBM_RADIO_HAL_SHADOW)
+   const sx126x_hal_shadow_entry_t *entry = Sx126xHalShadowEntry(state, command[0]);
+   const uint16_t paramsLength = (command_length - 1) + data_length;
+
+   if ((entry == NULL) || !entry->valid || (entry->length != paramsLength))
+   {
+      return false;
+   }
+
+   return (memcmp(entry->params, &command[1], command_length - 1) == 0) &&
+          ((data_length == 0) || (memcmp(&entry->params[command_length - 1], data, data_length) == 0));
+#else
+   return false;
+#endif
+}
+
+/**
+ * @brief Record the parameters of a shadowed command that was written.
+ */
+static void Sx126xHalShadowUpdate(sx126x_hal_state_t *state, const uint8_t *command, const uint16_t command_length,
+                                  const uint8_t *data, const uint16_t data_length)
+{
+#if defined(CONFIG_LBM_RADIO_HAL_SHADOW)
+   sx126x_hal_shadow_entry_t *entry = Sx126xHalShadowEntry(state, command[0]);
+   const uint16_t paramsLength = (command_length - 1) + data_length;
+
+   if (entry == NULL)
+   {
+      return;
+   }
+
+   // Changing the packet type resets the modulation and packet parameters.
+   if ((command[0] == SX126X_SET_PKT_TYPE) &&
+       !Sx126xHalShadowMatch(state, command, command_length, data, data_length))
+   {
+      Sx126xHalShadowInvalidate(state);
+   }
+
+   if (paramsLength > sizeof(entry->params))
+   {
+      entry->valid = false;
+      return;
+   }
+
+   memcpy(entry->params, &command[1], command_length - 1);
+   if (data_length != 0)
+   {
+      memcpy(&entry->params[command_length - 1], data, data_length);
+   }
+   entry->length = paramsLength;
+   entry->valid = true;
+#endif
+}
+
+/**
+ * @brief Forget all shadowed parameters.
+ */
+static void Sx126xHalShadowInvalidate(sx126x_hal_state_t *state)
+{
+#if defined(CONFIG_LBM_RADIO_HAL_SHADOW)
+   for (uint32_t i = 0; i < ARRAY_SIZE(state->shadow); i++)
+   {
+      state->shadow[i].valid = false;
+   }
+#endif
+}
+
+/**
+ * @brief Wait until the radio is ready for a command, waking it up if it sleeps.
+ *
+ * @param [in] sx126xContext Radio implementation parameters.
+ *
+ * @return SX126X_HAL_STATUS_ERROR if the radio is stuck busy.
+ */
+static sx126x_hal_status_t Sx126xHalCheckDeviceReady(const sx126x_hal_context_t *sx126xContext)
+{
+   sx126x_hal_status_t status;
+
+   sx126xContext->state->busyLastWaitUs = 0;
+   if (sx126xContext->state->radioMode != SX126X_HAL_RADIO_SLEEP)
+   {
+      status = Sx126xHalWaitOnBusy(sx126xContext);
    }
    else
    {
@@ -367,62 +875,95 @@ static void Sx126xHalCheckDeviceReady(const sx126x_hal_context_t *sx126xContext)
               sx126xContext->gpioCs.pin);
 
       // Busy is HIGH in sleep mode, wake-up the device with a small glitch on NSS.
+      // The radio releases BUSY once it is ready in STDBY_RC, so there is nothing
+      // more to wait for: a warm start is much shorter than a cold one.
       gpio_pin_set_dt(&sx126xContext->gpioCs, 1);
-      Sx126xHalWaitOnBusy(&sx126xContext->gpioBusy);
+      status = Sx126xHalWaitOnBusy(sx126xContext);
       gpio_pin_set_dt(&sx126xContext->gpioCs, 0);
-      radio_mode = RADIO_AWAKE;
+      sx126xContext->state->radioMode = SX126X_HAL_RADIO_AWAKE;
 
-      k_sleep(K_USEC(1000));
+      Sx126xHalWakeStatsRecord(sx126xContext->state,
+                               sx126xContext->state->warmStart ? SX126X_HAL_WAKE_WARM : SX126X_HAL_WAKE_COLD,
+                               sx126xContext->state->busyLastWaitUs);
    }
+
+   return status;
 }
 
-char *Sx126xCmdName(sx126x_commands_t cmd)
+/**
+ * @brief Update the radio state after a command was sent.
+ *
+ * @param [in] sx126xContext  Radio implementation parameters.
+ * @param [in] command        Command that was sent.
+ * @param [in] command_length Command size.
+ */
+static void Sx126xHalCommandSent(const sx126x_hal_context_t *sx126xContext, const uint8_t *command,
+                                 const uint16_t command_length, const uint8_t *data, const uint16_t data_length)
 {
-   switch (cmd)
+   sx126x_hal_state_t *state = sx126xContext->state;
+
+   state->busyOpcode = command[0];
+
+   // Check whether the command is a sleep command to keep the state up to date.
+   if ((command[0] == OPCODE_SET_SLEEP) && (command_length == CMD_SIZE_SET_SLEEP))
    {
-      case SX126X_SET_SLEEP:                    return "SET_SLEEP";
-      case SX126X_SET_STANDBY:                  return "SET_STANDBY";
-      case SX126X_SET_FS:                       return "SET_FS";
-      case SX126X_SET_TX:                       return "SET_TX";
-      case SX126X_SET_RX:                       return "SET_RX";
-      case SX126X_SET_STOP_TIMER_ON_PREAMBLE:   return "SET_STOP_TIMER_ON_PREAMBLE";
-      case SX126X_SET_RX_DUTY_CYCLE:            return "SET_RX_DUTY_CYCLE";
-      case SX126X_SET_CAD:                      return "SET_CAD";
-      case SX126X_SET_TX_CONTINUOUS_WAVE:       return "SET_TX_CONTINUOUS_WAVE";
-      case SX126X_SET_TX_INFINITE_PREAMBLE:     return "SET_TX_INFINITE_PREAMBLE";
-      case SX126X_SET_REGULATOR_MODE:           return "SET_REGULATOR_MODE";
-      case SX126X_CALIBRATE:                    return "CALIBRATE";
-      case SX126X_CALIBRATE_IMAGE:              return "CALIBRATE_IMAGE";
-      case SX126X_SET_PA_CFG:                   return "SET_PA_CFG";
-      case SX126X_SET_RX_TX_FALLBACK_MODE:      return "SET_RX_TX_FALLBACK_MODE";
-      case SX126X_WRITE_REGISTER:               return "WRITE_REGISTER";
-      case SX126X_READ_REGISTER:                return "READ_REGISTER";
-      case SX126X_WRITE_BUFFER:                 return "WRITE_BUFFER";
-      case SX126X_READ_BUFFER:                  return "READ_BUFFER";
-      case SX126X_SET_DIO_IRQ_PARAMS:           return "SET_DIO_IRQ_PARAMS";
-      case SX126X_GET_IRQ_STATUS:               return "GET_IRQ_STATUS";
-      case SX126X_CLR_IRQ_STATUS:               return "CLR_IRQ_STATUS";
-      case SX126X_SET_DIO2_AS_RF_SWITCH_CTRL:   return "SET_DIO2_AS_RF_SWITCH_CTRL";
-      case SX126X_SET_DIO3_AS_TCXO_CTRL:        return "SET_DIO3_AS_TCXO_CTRL";
-      case SX126X_SET_RF_FREQUENCY:             return "SET_RF_FREQUENCY";
-      case SX126X_SET_PKT_TYPE:                 return "SET_PKT_TYPE";
-      case SX126X_GET_PKT_TYPE:                 return "GET_PKT_TYPE";
-      case SX126X_SET_TX_PARAMS:                return "SET_TX_PARAMS";
-      case SX126X_SET_MODULATION_PARAMS:        return "SET_MODULATION_PARAMS";
-      case SX126X_SET_PKT_PARAMS:               return "SET_PKT_PARAMS";
-      case SX126X_SET_CAD_PARAMS:               return "SET_CAD_PARAMS";
-      case SX126X_SET_BUFFER_BASE_ADDRESS:      return "SET_BUFFER_BASE_ADDRESS";
-      case SX126X_SET_LORA_SYMB_NUM_TIMEOUT:    return "SET_LORA_SYMB_NUM_TIMEOUT";
-      case SX126X_GET_STATUS:                   return "GET_STATUS";
-      case SX126X_GET_RX_BUFFER_STATUS:         return "GET_RX_BUFFER_STATUS";
-      case SX126X_GET_PKT_STATUS:               return "GET_PKT_STATUS";
-      case SX126X_GET_RSSI_INST:                return "GET_RSSI_INST";
-      case SX126X_GET_STATS:                    return "GET_STATS";
-      case SX126X_RESET_STATS:                  return "RESET_STATS";
-      case SX126X_GET_DEVICE_ERRORS:            return "GET_DEVICE_ERRORS";
-      case SX126X_CLR_DEVICE_ERRORS:            return "CLR_DEVICE_ERRORS";
+      state->radioMode = SX126X_HAL_RADIO_SLEEP;
+      state->warmStart = ((command[1] & SLEEP_CFG_WARM_START) != 0);
+
+      // Only a warm start retains the configuration.
+      if (!state->warmStart)
+      {
+         Sx126xHalShadowInvalidate(state);
+      }
    }
+   else
+   {
+      Sx126xHalShadowUpdate(state, command, command_length, data, data_length);
+   }
+}
 
-   return "UNKNOWN CMD";
+/**
+ * @brief Get the number of status bytes returned by the radio before the data of a read command.
+ *
+ * @param [in] opcode Read command opcode.
+ *
+ * @return Status size in bytes.
+ */
+static uint16_t Sx126xHalReadStatusSize(const uint8_t opcode)
+{
+   if (opcode == OPCODE_READ_REGISTER)
+   {
+      return STATUS_SIZE_READ_REGISTER;
+   }
+   else if (opcode == OPCODE_READ_BUFFER)
+   {
+      return STATUS_SIZE_READ_BUFFER;
+   }
+
+   // Other read command.
+   return STATUS_SIZE_READ_CMD;
+}
+
+/**
+ * @brief Get the name of a command, for the logs.
+ *
+ * @param [in] cmd Command opcode.
+ *
+ * @return Command name, empty when the logs printing it are compiled out.
+ */
+const char *Sx126xCmdName(sx126x_commands_t cmd)
+{
+#if defined(CONFIG_LOG) && (CONFIG_LBM_LOG_LEVEL > LOG_LEVEL_NONE)
+   static const char *const names[SX126X_CMD_COUNT + 1] = {"UNKNOWN CMD", SX126X_CMD_LIST(SX126X_CMD_NAME)};
+   // Name position of each opcode, 0 if unknown.
+   static const uint8_t nameIndex[UINT8_MAX + 1] = {SX126X_CMD_LIST(SX126X_CMD_LOOKUP)};
+
+   BUILD_ASSERT(SX126X_CMD_COUNT < UINT8_MAX, "Command list too long for the name lookup");
+
+   return names[nameIndex[(uint8_t) cmd]];
+#else
+   ARG_UNUSED(cmd);
+   return "";
+#endif
 }
 
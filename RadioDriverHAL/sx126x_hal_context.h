@@ -69,6 +69,7 @@ extern "C"
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/spi.h>
 #include <zephyr/kernel.h>
@@ -83,19 +84,87 @@ extern "C"
  * --- PUBLIC CONSTANTS --------------------------------------------------------
  */
 
+// Number of shadowed configuration commands, and maximum parameters size of one.
+#define SX126X_HAL_SHADOW_ENTRIES           14
+#define SX126X_HAL_SHADOW_PARAMS_MAX_SIZE   16
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC TYPES ------------------------------------------------------------
  */
 
-// The context contains the SPI device and GPIOs to the SX126X.
+typedef enum
+{
+   SX126X_HAL_RADIO_AWAKE,
+   SX126X_HAL_RADIO_SLEEP
+} sx126x_hal_radio_mode_t;
+
+// How the radio was last started.
+typedef enum
+{
+   SX126X_HAL_WAKE_WARM,         // Wake-up from sleep with configuration retention
+   SX126X_HAL_WAKE_COLD,         // Wake-up from sleep without retention
+   SX126X_HAL_WAKE_RESET,        // Hardware reset
+   SX126X_HAL_WAKE_KINDS
+} sx126x_hal_wake_kind_t;
+
+// Start-up latencies of one kind, from the NSS glitch or reset release to BUSY low.
+typedef struct
+{
+   uint32_t                count;
+   uint32_t                lastUs;
+   uint32_t                maxUs;
+   uint64_t                totalUs;
+} sx126x_hal_wake_stats_t;
+
+// Last parameters written with a shadowed command.
+typedef struct
+{
+   bool                    valid;
+   uint8_t                 length;
+   uint8_t                 params[SX126X_HAL_SHADOW_PARAMS_MAX_SIZE];
+} sx126x_hal_shadow_entry_t;
+
+// The state of one radio, owned by the HAL. Zero-initialised storage is a valid
+// initial state (radio awake, nothing configured).
 typedef struct
 {
-   struct spi_dt_spec      spiSpec;    // SPI bus device
-   struct gpio_dt_spec     gpioCs;     // NSS Slave Select GPIO
-   struct gpio_dt_spec     gpioReset;  // Reset GPIO
-   struct gpio_dt_spec     gpioBusy;   // Busy GPIO
-   struct gpio_dt_spec     gpioDio1;   // DIO1 GPIO
+   volatile sx126x_hal_radio_mode_t radioMode;
+
+   // Sleep with configuration retention, last start kind and start-up latencies.
+   bool                    warmStart;
+   sx126x_hal_wake_kind_t  lastWake;
+   sx126x_hal_wake_stats_t wakeStats[SX126X_HAL_WAKE_KINDS];
+
+   // Radio GPIOs configured.
+   bool                    gpioInit;
+
+   // BUSY falling-edge interrupt.
+   bool                    busyIrqInit;
+   struct k_sem            busySem;
+   struct gpio_callback    busyCallbackData;
+
+   // Opcode of the last command sent, i.e. the command the radio is busy with,
+   // and BUSY wait time before the current command.
+   uint8_t                 busyOpcode;
+   uint32_t                busyLastWaitUs;
+
+   // Last configuration written, and commands skipped because identical to it.
+   sx126x_hal_shadow_entry_t shadow[SX126X_HAL_SHADOW_ENTRIES];
+   uint32_t                shadowElidedCmds;
+   uint32_t                shadowElidedBytes;
+} sx126x_hal_state_t;
+
+// The context contains the SPI device and GPIOs to the SX126X, and the state of the radio.
+typedef struct
+{
+   struct spi_dt_spec      spiSpec;       // SPI bus device
+   struct gpio_dt_spec     gpioCs;        // NSS Slave Select GPIO
+   struct gpio_dt_spec     gpioReset;     // Reset GPIO
+   struct gpio_dt_spec     gpioBusy;      // Busy GPIO
+   struct gpio_dt_spec     gpioDio1;      // DIO1 GPIO
+   bool                    dio2TxEnable;  // DIO2 drives the RF switch
+   sx126x_hal_state_t      *state;        // Radio state, one per radio
 } sx126x_hal_context_t;
 
 /*
@@ -103,6 +172,62 @@ typedef struct
  * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
  */
 
+/**
+ * @brief Log the per-opcode BUSY wait-time histogram and the BUSY timeout count.
+ *
+ * @remark The statistics are shared by all the radios.
+ */
+void sx126x_hal_busy_stats_log(void);
+
+/**
+ * @brief Clear the BUSY wait-time histogram and the BUSY timeout count.
+ */
+void sx126x_hal_busy_stats_reset(void);
+
+/**
+ * @brief Get the number of configuration commands skipped because they were identical
+ *        to the last ones written, and the number of SPI bytes saved.
+ *
+ * @param [in]  context         Radio implementation parameters.
+ * @param [out] elidedCommands  Number of skipped commands.
+ * @param [out] elidedBytes     Number of skipped command and data bytes.
+ */
+void sx126x_hal_shadow_stats_get(const void *context, uint32_t *elidedCommands, uint32_t *elidedBytes);
+
+/**
+ * @brief Forget the last configuration written, so the next configuration commands are all sent.
+ *
+ * @remark To be called if the radio configuration is changed behind the HAL.
+ *
+ * @param [in] context Radio implementation parameters.
+ */
+void sx126x_hal_shadow_invalidate(const void *context);
+
+/**
+ * @brief Get the start-up latencies of a radio.
+ *
+ * @param [in]  context Radio implementation parameters.
+ * @param [in]  kind    Warm wake-up, cold wake-up or reset.
+ * @param [out] stats   Start-up latencies of this kind.
+ */
+void sx126x_hal_wake_stats_get(const void *context, sx126x_hal_wake_kind_t kind, sx126x_hal_wake_stats_t *stats);
+
+/**
+ * @brief Get how a radio was last started.
+ *
+ * @param [in] context Radio implementation parameters.
+ *
+ * @return Warm wake-up, cold wake-up or reset.
+ */
+sx126x_hal_wake_kind_t sx126x_hal_last_wake_get(const void *context);
+
+/**
+ * @brief Log the start-up latencies of a radio.
+ *
+ * @param [in] context Radio implementation parameters.
+ */
+void sx126x_hal_wake_stats_log(const void *context);
+
 #ifdef __cplusplus
 }
 #endif
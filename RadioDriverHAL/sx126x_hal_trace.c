@@ -0,0 +1,144 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Binary trace of the SX126x SPI transactions.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include "sx126x_hal_trace.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+// Number of bytes printed per line by sx126x_hal_trace_dump().
+#define DUMP_BYTES_PER_LINE   32
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC VARIABLES --------------------------------------------------------
+ */
+
+sx126x_hal_trace_t sx126x_hal_trace =
+{
+   .magic        = SX126X_TRACE_MAGIC,
+   .version      = SX126X_TRACE_VERSION,
+   .recordSize   = sizeof(sx126x_hal_trace_record_t),
+   .recordCount  = CONFIG_LBM_RADIO_HAL_TRACE_RECORDS,
+   .payloadSize  = CONFIG_LBM_RADIO_HAL_TRACE_PAYLOAD_SIZE,
+   .cyclesPerSec = CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC,
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+// Protects the head of the trace, written by the threads of all the radios.
+static struct k_spinlock traceLock;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void sx126x_hal_trace_dump(void)
+{
+   const uint8_t *raw = (const uint8_t *) &sx126x_hal_trace;
+   const size_t size = sizeof(sx126x_hal_trace);
+
+   // Set at build time too, for a ring read by a debugger; this one is right
+   // when the timer reads its frequency at run time.
+   sx126x_hal_trace.cyclesPerSec = sys_clock_hw_cycles_per_sec();
+
+   printk("SXTR: BEGIN %u\n", (unsigned) size);
+   for (size_t offset = 0; offset < size; offset += DUMP_BYTES_PER_LINE)
+   {
+      const size_t count = MIN(DUMP_BYTES_PER_LINE, size - offset);
+
+      printk("SXTR:");
+      for (size_t i = 0; i < count; i++)
+      {
+         printk("%02x", raw[offset + i]);
+      }
+      printk("\n");
+   }
+   printk("SXTR: END\n");
+}
+
+void sx126x_hal_trace_clear(void)
+{
+   k_spinlock_key_t key = k_spin_lock(&traceLock);
+
+   memset(sx126x_hal_trace.records, 0, sizeof(sx126x_hal_trace.records));
+   sx126x_hal_trace.head = 0;
+   k_spin_unlock(&traceLock, key);
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- INTERNAL FUNCTIONS DEFINITION -------------------------------------------
+ */
+
+/**
+ * @brief Record a command in the trace buffer.
+ *
+ * @param [in] startCycles    Cycle counter at the start of the command.
+ * @param [in] flags          SX126X_TRACE_FLAG_xxx.
+ * @param [in] busyWaitUs     BUSY wait before the command.
+ * @param [in] command        Command bytes.
+ * @param [in] command_length Number of command bytes.
+ * @param [in] data           Data bytes, or NULL.
+ * @param [in] data_length    Number of data bytes.
+ */
+void Sx126xHalTraceRecord(const uint32_t startCycles, const uint8_t flags, const uint32_t busyWaitUs,
+                          const uint8_t *command, const uint16_t command_length,
+                          const uint8_t *data, const uint16_t data_length)
+{
+   const uint32_t durationUs = k_cyc_to_us_floor32(k_cycle_get_32() - startCycles);
+   k_spinlock_key_t key = k_spin_lock(&traceLock);
+   sx126x_hal_trace_record_t *record =
+      &sx126x_hal_trace.records[sx126x_hal_trace.head % CONFIG_LBM_RADIO_HAL_TRACE_RECORDS];
+   uint16_t used = 0;
+
+   sx126x_hal_trace.head++;
+
+   record->cycles        = startCycles;
+   record->opcode        = (command_length > 0) ? command[0] : 0;
+   record->flags         = flags;
+   record->commandLength = command_length;
+   record->dataLength    = data_length;
+   record->busyWaitUs    = (uint16_t) MIN(busyWaitUs, UINT16_MAX);
+   record->durationUs    = (uint16_t) MIN(durationUs, UINT16_MAX);
+
+   // Command parameters (without opcode) then data.
+   if (command_length > 1)
+   {
+      used = MIN((size_t) (command_length - 1), sizeof(record->payload));
+      memcpy(record->payload, &command[1], used);
+   }
+   if ((data != NULL) && (used < sizeof(record->payload)))
+   {
+      const uint16_t count = MIN(data_length, sizeof(record->payload) - used);
+
+      memcpy(&record->payload[used], data, count);
+      used += count;
+   }
+   memset(&record->payload[used], 0, sizeof(record->payload) - used);
+   k_spin_unlock(&traceLock, key);
+}
@@ -0,0 +1,117 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Binary trace of the SX126x SPI transactions.
+*
+* @details  Each command is recorded in a RAM ring buffer with a cycle counter
+*           timestamp, its duration, the BUSY wait time and the first bytes of its payload.
+*           The ring is the global sx126x_hal_trace, so it can be dumped by a
+*           debugger, or printed with sx126x_hal_trace_dump(). Use
+*           tools/sx126x_trace_decode.py to decode it on the host.
+******************************************************************************/
+
+#ifndef SX126X_HAL_TRACE_H
+#define SX126X_HAL_TRACE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+// Trace header magic, "SXTR" in little endian.
+#define SX126X_TRACE_MAGIC          0x52545853
+#define SX126X_TRACE_VERSION        1
+
+// Record flags.
+#define SX126X_TRACE_FLAG_READ      0x01
+#define SX126X_TRACE_FLAG_ELIDED    0x02
+#define SX126X_TRACE_FLAG_ERROR     0x04
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+#if defined(CONFIG_LBM_RADIO_HAL_TRACE)
+
+typedef struct __packed sx126x_hal_trace_record_s
+{
+   uint32_t cycles;           // Cycle counter at the start of the command.
+   uint8_t  opcode;
+   uint8_t  flags;            // SX126X_TRACE_FLAG_xxx.
+   uint16_t commandLength;
+   uint16_t dataLength;
+   uint16_t busyWaitUs;       // BUSY wait before the command, saturated.
+   uint16_t durationUs;       // Total command duration, BUSY wait included, saturated.
+   uint8_t  payload[CONFIG_LBM_RADIO_HAL_TRACE_PAYLOAD_SIZE];
+} sx126x_hal_trace_record_t;
+
+typedef struct __packed sx126x_hal_trace_s
+{
+   uint32_t magic;
+   uint16_t version;
+   uint16_t recordSize;
+   uint16_t recordCount;
+   uint16_t payloadSize;
+   uint32_t cyclesPerSec;
+   uint32_t head;             // Total number of records written.
+   sx126x_hal_trace_record_t records[CONFIG_LBM_RADIO_HAL_TRACE_RECORDS];
+} sx126x_hal_trace_t;
+
+extern sx126x_hal_trace_t sx126x_hal_trace;
+
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Record a command in the trace buffer. Called by the radio HAL only.
+ */
+#if defined(CONFIG_LBM_RADIO_HAL_TRACE)
+void Sx126xHalTraceRecord(const uint32_t startCycles, const uint8_t flags, const uint32_t busyWaitUs,
+                          const uint8_t *command, const uint16_t command_length,
+                          const uint8_t *data, const uint16_t data_length);
+#else
+static inline void Sx126xHalTraceRecord(const uint32_t startCycles, const uint8_t flags, const uint32_t busyWaitUs,
+                                        const uint8_t *command, const uint16_t command_length,
+                                        const uint8_t *data, const uint16_t data_length)
+{
+}
+#endif
+
+/**
+ * @brief Print the trace buffer on the console, as hex lines prefixed by "SXTR:".
+ */
+void sx126x_hal_trace_dump(void);
+
+/**
+ * @brief Clear the trace buffer.
+ */
+void sx126x_hal_trace_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SX126X_HAL_TRACE_H
@@ -0,0 +1,77 @@
+# COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF
+# EXPONENTIAL TECHNOLOGY GROUP.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Build the HAL directories into a test application, with the sources selected
+# by their Kconfig options as in the Lorawan application. The LoRa Basics Modem
+# headers are used, but only the radio driver is built: the tests drive the
+# HAL directly.
+
+set(REPO_DIR ${CMAKE_CURRENT_LIST_DIR}/../..)
+set(LBM_DIR ${REPO_DIR}/LoRaBasicsModem_SWL2001)
+
+# Add the sources set in FILES by the CMakeLists.txt of a HAL directory.
+macro(hal_sources dir)
+  include(${REPO_DIR}/${dir}/CMakeLists.txt)
+  list(TRANSFORM FILES PREPEND ${REPO_DIR}/${dir}/)
+  target_sources(app PRIVATE ${FILES})
+endmacro()
+
+# SX126x driver, RAL and RALF, for the board layer.
+macro(hal_radio_driver_sources)
+  target_sources(app PRIVATE
+    ${LBM_DIR}/smtc_modem_core/radio_drivers/sx126x_driver/src/sx126x.c
+    ${LBM_DIR}/smtc_modem_core/smtc_ral/src/ral_sx126x.c
+    ${LBM_DIR}/smtc_modem_core/smtc_ralf/src/ralf_sx126x.c
+  )
+endmacro()
+
+target_include_directories(app PRIVATE
+    ${LBM_DIR}
+    ${LBM_DIR}/smtc_modem_api
+    ${LBM_DIR}/smtc_modem_core
+    ${LBM_DIR}/smtc_modem_core/device_management
+    ${LBM_DIR}/smtc_modem_core/lorawan_api
+    ${LBM_DIR}/smtc_modem_core/lr1mac
+    ${LBM_DIR}/smtc_modem_core/lr1mac/src
+    ${LBM_DIR}/smtc_modem_core/lr1mac/src/lr1mac_class_b
+    ${LBM_DIR}/smtc_modem_core/lr1mac/src/lr1mac_class_c
+    ${LBM_DIR}/smtc_modem_core/lr1mac/src/services
+    ${LBM_DIR}/smtc_modem_core/lr1mac/src/smtc_real/src
+    ${LBM_DIR}/smtc_modem_core/modem_config
+    ${LBM_DIR}/smtc_modem_core/modem_core
+    ${LBM_DIR}/smtc_modem_core/modem_services
+    ${LBM_DIR}/smtc_modem_core/modem_supervisor
+    ${LBM_DIR}/smtc_modem_core/radio_drivers/sx126x_driver/src
+    ${LBM_DIR}/smtc_modem_core/radio_planner/src
+    ${LBM_DIR}/smtc_modem_core/smtc_modem_crypto
+    ${LBM_DIR}/smtc_modem_core/smtc_modem_crypto/smtc_secure_element
+    ${LBM_DIR}/smtc_modem_core/smtc_modem_crypto/soft_secure_element
+    ${LBM_DIR}/smtc_modem_core/smtc_modem_services
+    ${LBM_DIR}/smtc_modem_core/smtc_modem_services/headers
+    ${LBM_DIR}/smtc_modem_core/smtc_modem_services/src
+    ${LBM_DIR}/smtc_modem_core/smtc_ral/src
+    ${LBM_DIR}/smtc_modem_core/smtc_ralf/src
+    ${LBM_DIR}/smtc_modem_hal
+    ${REPO_DIR}/ModemHAL
+    ${REPO_DIR}/RadioDriverHAL
+    ${REPO_DIR}/RALBSP
+    )
+
+# Compile definitions of the LoRa Basics Modem headers, as in the application.
+target_compile_definitions(app PRIVATE
+    ADD_D2D=no
+    ADD_MULTICAST=yes
+    ADD_SMTC_ALC_SYNC=yes
+    ADD_SMTC_FILE_UPLOAD=yes
+    ADD_SMTC_STREAM=yes
+    CRYPTO=SOFT
+    MIDDLEWARE=no
+    RP2_103
+    SMTC_D2D
+    SMTC_MULTICAST
+    SX126X SX1262
+    USE_GNSS=no
+    USER_DEFINED_JOIN_PARAMETERS
+    )
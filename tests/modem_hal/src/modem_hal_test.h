@@ -0,0 +1,51 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Shared helpers of the modem HAL tests.
+******************************************************************************/
+
+#ifndef MODEM_HAL_TEST_H
+#define MODEM_HAL_TEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <zephyr/drivers/emul.h>
+
+#include "sx126x_hal_context.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Get the radio used by the modem HAL, the emulated lora0 radio.
+ *
+ * @return Radio context, returned by modem_context_get_modem_radio_ctx().
+ */
+const sx126x_hal_context_t *TestRadioContext(void);
+
+/**
+ * @brief Get the emulator of the radio used by the modem HAL.
+ *
+ * @return Emulated radio.
+ */
+const struct emul *TestRadioEmul(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MODEM_HAL_TEST_H
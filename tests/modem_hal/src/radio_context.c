@@ -0,0 +1,71 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Radio of the modem HAL tests.
+*
+* @details  The modem HAL gets its radio from the LoRa Basics Modem context,
+*           which isn't built in the tests. It is the lora0 radio instead, set
+*           up like the board does.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/emul.h>
+
+#include "modem_context.h"
+#include "sx126x_hal_context.h"
+#include "modem_hal_test.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define LORA_RADIO_NODE_ID          DT_ALIAS(lora0)
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static sx126x_hal_state_t     radioState;
+
+static const sx126x_hal_context_t radioContext = {
+   .spiSpec      = SPI_DT_SPEC_GET(LORA_RADIO_NODE_ID, SPI_WORD_SET(8) | SPI_TRANSFER_MSB, 0),
+   .gpioCs       = SPI_CS_GPIOS_DT_SPEC_GET(LORA_RADIO_NODE_ID),
+   .gpioReset    = GPIO_DT_SPEC_GET(LORA_RADIO_NODE_ID, reset_gpios),
+   .gpioBusy     = GPIO_DT_SPEC_GET(LORA_RADIO_NODE_ID, busy_gpios),
+   .gpioDio1     = GPIO_DT_SPEC_GET(LORA_RADIO_NODE_ID, dio1_gpios),
+   .dio2TxEnable = DT_PROP(LORA_RADIO_NODE_ID, dio2_tx_enable),
+   .state        = &radioState,
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+const void *modem_context_get_modem_radio_ctx(void)
+{
+   return &radioContext;
+}
+
+const sx126x_hal_context_t *TestRadioContext(void)
+{
+   return &radioContext;
+}
+
+const struct emul *TestRadioEmul(void)
+{
+   return EMUL_DT_GET(LORA_RADIO_NODE_ID);
+}
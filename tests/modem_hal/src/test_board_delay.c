@@ -0,0 +1,111 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Tests of the board delay calibration of the modem HAL.
+*
+* @details  The emulated radio holds BUSY for a configurable time after each
+*           command, standing for the latency of a real board. The calibrated
+*           board delay must follow it, and a stored calibration must be used
+*           without measuring again.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_ext.h"
+#include "sx126x_emul.h"
+#include "modem_hal_test.h"
+
+#if defined(CONFIG_LBM_MODEM_HAL_BOARD_DELAY_CALIBRATION)
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define BOARD_DELAY_KEY             "lbm_hal/board_delay_us"
+
+// BUSY times of the emulated radio, shortest first.
+static const uint32_t busyTimesUs[] = {200, 1500, 4000};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Calibrate with a BUSY time of the emulated radio.
+ *
+ * @param [in] busyUs  BUSY time after each command.
+ * @param [in] measure Erase the stored calibration first.
+ *
+ * @return Board delay in milliseconds.
+ */
+static int8_t BoardDelayCalibrate(const uint32_t busyUs, const bool measure)
+{
+   if (measure)
+   {
+      (void) settings_delete(BOARD_DELAY_KEY);
+   }
+
+   sx126x_emul_set_timing(TestRadioEmul(), busyUs, CONFIG_LBM_RADIO_HAL_EMUL_RX_DELAY_US);
+   zassert_equal(smtc_modem_hal_board_delay_calibrate(TestRadioContext()), 0, "Calibration failed");
+
+   return smtc_modem_hal_get_board_delay_ms();
+}
+
+static void BoardDelayAfter(void *fixture)
+{
+   sx126x_emul_set_timing(TestRadioEmul(), CONFIG_LBM_RADIO_HAL_EMUL_BUSY_US, CONFIG_LBM_RADIO_HAL_EMUL_RX_DELAY_US);
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- TESTS -------------------------------------------------------------------
+ */
+
+ZTEST(modem_hal_board_delay, test_tracks_busy_time)
+{
+   int8_t lastMs = 0;
+
+   for (uint32_t i = 0; i < ARRAY_SIZE(busyTimesUs); i++)
+   {
+      const uint32_t busyUs = busyTimesUs[i];
+      const int8_t delayMs = BoardDelayCalibrate(busyUs, true);
+
+      TC_PRINT("BUSY %u us: board delay %d ms.\n", busyUs, delayMs);
+
+      // The command BUSY, plus at most the sleep command BUSY and the wake-up.
+      zassert_between_inclusive((uint32_t) delayMs, DIV_ROUND_UP(busyUs, USEC_PER_MSEC),
+                                DIV_ROUND_UP(3 * busyUs, USEC_PER_MSEC) + 1, "BUSY %u us", busyUs);
+      zassert_true(delayMs >= lastMs, "Board delay %d ms, %d ms with a shorter BUSY", delayMs, lastMs);
+      lastMs = delayMs;
+   }
+}
+
+ZTEST(modem_hal_board_delay, test_stored_calibration_used)
+{
+   const uint32_t busyUs = busyTimesUs[ARRAY_SIZE(busyTimesUs) - 1];
+   const int8_t calibratedMs = BoardDelayCalibrate(busyUs, true);
+
+   // Faster radio, same board and SPI configuration: the stored calibration is kept.
+   zassert_equal(BoardDelayCalibrate(busyTimesUs[0], false), calibratedMs, "Calibration measured again");
+}
+
+ZTEST_SUITE(modem_hal_board_delay, NULL, NULL, NULL, BoardDelayAfter, NULL);
+
+#endif
@@ -0,0 +1,144 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Tests of the clock drift compensation of the modem HAL.
+*
+* @details  The native_sim clock doesn't drift: the network time synchronizations
+*           are simulated for a local clock 20 ppm fast, some of them with a
+*           network time error.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_ext.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define SIMULATED_DRIFT_PPB         20000
+#define DRIFT_TOLERANCE_PPB         1000
+
+// Network time error of a bad synchronization: 66 ppm over the interval.
+#define SYNC_ERROR_MS               40
+
+// Just over the minimum interval between two drift measurements.
+#define SYNC_INTERVAL_S             (CONFIG_LBM_MODEM_HAL_DRIFT_MIN_INTERVAL_S + 1)
+
+// Long enough for the compensation to reach 2 s.
+#define COMPENSATION_PERIOD_S       100000
+#define COMPENSATION_EXPECTED_S     (-(int32_t) (((int64_t) COMPENSATION_PERIOD_S * SIMULATED_DRIFT_PPB) / 1000000000))
+
+#define GPS_START_S                 1300000000LL
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+// Simulated network time, and local time of the last synchronization.
+static int64_t                networkMs;
+static int64_t                syncLocalMs;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Synchronize on the simulated network time.
+ *
+ * @param [in] errorMs Error of the network time given to the modem HAL.
+ */
+static void DriftSync(int32_t errorMs)
+{
+   const int64_t localMs = k_uptime_get();
+   const int64_t elapsedMs = localMs - syncLocalMs;
+   int64_t reportedMs;
+
+   // The local clock is fast: less network time elapsed.
+   networkMs += elapsedMs - ((elapsedMs * SIMULATED_DRIFT_PPB) / 1000000000LL);
+   syncLocalMs = localMs;
+
+   reportedMs = networkMs + errorMs;
+   smtc_modem_hal_drift_sync((uint32_t) (reportedMs / 1000), (uint32_t) (reportedMs % 1000));
+}
+
+static void *DriftSetup(void)
+{
+   networkMs = GPS_START_S * 1000;
+   syncLocalMs = k_uptime_get();
+
+   return NULL;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- TESTS -------------------------------------------------------------------
+ */
+
+ZTEST(modem_hal_drift, test_simulated_drift)
+{
+   const uint32_t learnedErrorPpm = DIV_ROUND_UP(SIMULATED_DRIFT_PPB, 1000);
+   int32_t compensationS;
+
+   zassert_equal(smtc_modem_hal_drift_get_clock_error_ppm(), CONFIG_LBM_MODEM_HAL_DRIFT_CRYSTAL_PPM,
+                 "Clock error before the drift is learned");
+
+   // The first synchronization is 40 ms off: the drift measured from it is dropped.
+   DriftSync(SYNC_ERROR_MS);
+   k_sleep(K_SECONDS(SYNC_INTERVAL_S));
+   DriftSync(0);
+   zassert_equal(smtc_modem_hal_drift_get_ppb(), 0, "Network time error taken as a drift");
+   zassert_equal(smtc_modem_hal_drift_get_clock_error_ppm(), CONFIG_LBM_MODEM_HAL_DRIFT_CRYSTAL_PPM);
+
+   // Then the drift is learned from the good synchronizations.
+   for (uint32_t i = 0; i < 3; i++)
+   {
+      k_sleep(K_SECONDS(SYNC_INTERVAL_S));
+      DriftSync(0);
+   }
+   zassert_within(smtc_modem_hal_drift_get_ppb(), SIMULATED_DRIFT_PPB, DRIFT_TOLERANCE_PPB,
+                  "Drift %d ppb", smtc_modem_hal_drift_get_ppb());
+
+   // The modem timings are not compensated: the clock error covers the drift.
+   zassert_between_inclusive(smtc_modem_hal_drift_get_clock_error_ppm(), learnedErrorPpm,
+                             CONFIG_LBM_MODEM_HAL_DRIFT_CRYSTAL_PPM - 1,
+                             "Clock error %u ppm", smtc_modem_hal_drift_get_clock_error_ppm());
+   zassert_true(smtc_modem_hal_drift_get_residual_ppm() < learnedErrorPpm, "Residual error %u ppm",
+                smtc_modem_hal_drift_get_residual_ppm());
+
+   // A later network time error doesn't move the learned drift.
+   k_sleep(K_SECONDS(SYNC_INTERVAL_S));
+   DriftSync(SYNC_ERROR_MS);
+   for (uint32_t i = 0; i < 2; i++)
+   {
+      k_sleep(K_SECONDS(SYNC_INTERVAL_S));
+      DriftSync(0);
+   }
+   zassert_within(smtc_modem_hal_drift_get_ppb(), SIMULATED_DRIFT_PPB, DRIFT_TOLERANCE_PPB,
+                  "Drift %d ppb after a network time error", smtc_modem_hal_drift_get_ppb());
+
+   // The seconds are compensated.
+   compensationS = smtc_modem_hal_get_time_compensation_in_s();
+   k_sleep(K_SECONDS(COMPENSATION_PERIOD_S));
+   compensationS = smtc_modem_hal_get_time_compensation_in_s() - compensationS;
+   zassert_within(compensationS, COMPENSATION_EXPECTED_S, 1, "Compensation %d s", compensationS);
+}
+
+ZTEST_SUITE(modem_hal_drift, NULL, DriftSetup, NULL, NULL, NULL);
@@ -0,0 +1,185 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Tests of the random numbers of the modem HAL.
+*
+* @details  The native_sim entropy driver is seeded from the command line, so
+*           the statistical tests are reproducible. The chi-square limits are
+*           the 0.01 % critical values, in hundredths. The native_sim clock
+*           doesn't advance while the CPU runs: the throughput is checked as
+*           the share of the random numbers served from the pool, and the time
+*           per number is only reported.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_ext.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+// Small range, as a channel index: 10 values, 9 degrees of freedom.
+#define SMALL_RANGE_MIN             3
+#define SMALL_RANGE_MAX             12
+#define SMALL_RANGE_SAMPLES         100000
+#define SMALL_RANGE_CHI2_MAX        3372
+
+// 3 x 2^30 values: a plain modulo would draw the first third twice as often.
+// Counted in thirds, 2 degrees of freedom.
+#define LARGE_RANGE_MAX             0xBFFFFFFFU
+#define LARGE_RANGE_THIRD           0x40000000U
+#define LARGE_RANGE_SAMPLES         30000
+#define LARGE_RANGE_CHI2_MAX        1842
+
+#define BURST_WORDS                 (CONFIG_LBM_MODEM_HAL_ENTROPY_POOL_WORDS / 2)
+#define THROUGHPUT_WORDS            10000
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief Chi-square statistic of counts against the uniform distribution.
+ *
+ * @return Statistic in hundredths. The samples are a multiple of the buckets.
+ */
+static uint32_t ChiSquare(const uint32_t *counts, const uint32_t buckets, const uint32_t samples)
+{
+   const int64_t expected = samples / buckets;
+   int64_t chi2 = 0;
+
+   for (uint32_t i = 0; i < buckets; i++)
+   {
+      const int64_t delta = (int64_t) counts[i] - expected;
+
+      chi2 += delta * delta * 100;
+   }
+
+   return (uint32_t) (chi2 / expected);
+}
+
+/**
+ * @brief Let the refill work fill the pool.
+ */
+static void EntropyBefore(void *fixture)
+{
+   k_msleep(1);
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- TESTS -------------------------------------------------------------------
+ */
+
+ZTEST(modem_hal_entropy, test_range_bounds)
+{
+   for (uint32_t i = 0; i < 1000; i++)
+   {
+      const uint32_t value = smtc_modem_hal_get_random_nb_in_range(SMALL_RANGE_MAX, SMALL_RANGE_MIN);
+      const int32_t signedValue = smtc_modem_hal_get_signed_random_nb_in_range(-5, 4);
+
+      zassert_between_inclusive(value, SMALL_RANGE_MIN, SMALL_RANGE_MAX);
+      zassert_between_inclusive(signedValue, -5, 4);
+   }
+
+   zassert_equal(smtc_modem_hal_get_random_nb_in_range(7, 7), 7);
+   zassert_equal(smtc_modem_hal_get_signed_random_nb_in_range(INT32_MIN, INT32_MIN), INT32_MIN);
+}
+
+ZTEST(modem_hal_entropy, test_small_range_uniform)
+{
+   uint32_t counts[SMALL_RANGE_MAX - SMALL_RANGE_MIN + 1] = {0};
+   uint32_t chi2;
+
+   for (uint32_t i = 0; i < SMALL_RANGE_SAMPLES; i++)
+   {
+      counts[smtc_modem_hal_get_random_nb_in_range(SMALL_RANGE_MIN, SMALL_RANGE_MAX) - SMALL_RANGE_MIN]++;
+   }
+
+   chi2 = ChiSquare(counts, ARRAY_SIZE(counts), SMALL_RANGE_SAMPLES);
+   TC_PRINT("Small range chi-square: %u.%02u\n", chi2 / 100, chi2 % 100);
+   zassert_true(chi2 < SMALL_RANGE_CHI2_MAX, "Chi-square %u.%02u", chi2 / 100, chi2 % 100);
+}
+
+ZTEST(modem_hal_entropy, test_large_range_unbiased)
+{
+   uint32_t counts[3] = {0};
+   uint32_t chi2;
+
+   for (uint32_t i = 0; i < LARGE_RANGE_SAMPLES; i++)
+   {
+      counts[smtc_modem_hal_get_random_nb_in_range(0, LARGE_RANGE_MAX) / LARGE_RANGE_THIRD]++;
+   }
+
+   chi2 = ChiSquare(counts, ARRAY_SIZE(counts), LARGE_RANGE_SAMPLES);
+   TC_PRINT("Large range thirds: %u %u %u, chi-square: %u.%02u\n", counts[0], counts[1], counts[2],
+            chi2 / 100, chi2 % 100);
+   zassert_true(chi2 < LARGE_RANGE_CHI2_MAX, "Chi-square %u.%02u", chi2 / 100, chi2 % 100);
+}
+
+ZTEST(modem_hal_entropy, test_burst_from_pool)
+{
+   smtc_modem_hal_entropy_stats_t before;
+   smtc_modem_hal_entropy_stats_t after;
+
+   // A burst of the modem thread never waits for the driver.
+   smtc_modem_hal_entropy_stats_get(&before);
+   for (uint32_t i = 0; i < BURST_WORDS; i++)
+   {
+      (void) smtc_modem_hal_get_random_nb();
+   }
+   smtc_modem_hal_entropy_stats_get(&after);
+
+   zassert_equal(after.poolWords - before.poolWords, BURST_WORDS);
+   zassert_equal(after.poolMisses, before.poolMisses, "Pool empty during a burst");
+}
+
+ZTEST(modem_hal_entropy, test_throughput)
+{
+   smtc_modem_hal_entropy_stats_t before;
+   smtc_modem_hal_entropy_stats_t after;
+   uint32_t poolWords;
+   uint32_t startCycles;
+   uint32_t elapsedUs;
+
+   smtc_modem_hal_entropy_stats_get(&before);
+   startCycles = k_cycle_get_32();
+   for (uint32_t i = 0; i < THROUGHPUT_WORDS; i++)
+   {
+      (void) smtc_modem_hal_get_random_nb();
+
+      // The modem thread yields between its random numbers, as between its tasks.
+      if ((i % BURST_WORDS) == 0)
+      {
+         k_yield();
+      }
+   }
+   elapsedUs = k_cyc_to_us_floor32(k_cycle_get_32() - startCycles);
+   smtc_modem_hal_entropy_stats_get(&after);
+
+   poolWords = after.poolWords - before.poolWords;
+   TC_PRINT("%u random numbers in %u us, %u from the pool, %u driver reads.\n", THROUGHPUT_WORDS, elapsedUs,
+            poolWords, after.refills - before.refills);
+
+   zassert_equal(poolWords + (after.poolMisses - before.poolMisses), THROUGHPUT_WORDS);
+   zassert_equal(poolWords, THROUGHPUT_WORDS, "Pool not refilled in time");
+}
+
+ZTEST_SUITE(modem_hal_entropy, NULL, NULL, EntropyBefore, NULL, NULL);
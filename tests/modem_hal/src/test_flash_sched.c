@@ -0,0 +1,219 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Tests of the flash write scheduling of the modem HAL.
+*
+* @details  The test plays the modem: it opens RX windows on the emulated
+*           radio and reports the idle times between them. The context writes
+*           are observed by wrapping settings_save_one() at link time, and
+*           must never start or end while the radio is awake.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/ztest.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_ext.h"
+#include "sx126x_hal.h"
+#include "sx126x_emul.h"
+#include "modem_hal_test.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+// SX126X_SET_RX, continuous, and SX126X_SET_SLEEP with warm start.
+#define OPCODE_SET_RX               0x82
+#define RX_TIMEOUT_CONTINUOUS       0xFF
+#define OPCODE_SET_SLEEP            0x84
+#define SLEEP_CFG_WARM_START        0x04
+
+#define RX_WINDOW_MS                50
+#define IDLE_GAP_MS                 (2 * CONFIG_LBM_MODEM_HAL_FLASH_SCHED_MIN_GAP_MS)
+
+// Modem cycles, an idle time then an RX window, beyond the flush deadline.
+#define MODEM_CYCLES                (2 * CONFIG_LBM_MODEM_HAL_CONTEXT_FLUSH_DELAY_MS / (IDLE_GAP_MS + RX_WINDOW_MS) + 1)
+
+#define CONTEXT_SIZE                16
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint32_t               saveCount;
+static uint32_t               saveOverlaps;
+static int64_t                firstSaveMs;
+
+static uint8_t                contextData[CONTEXT_SIZE];
+static int                    testPriority;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+int __real_settings_save_one(const char *name, const void *value, size_t val_len);
+
+/**
+ * @brief Context writes of the modem HAL, checked against the RX windows.
+ */
+int __wrap_settings_save_one(const char *name, const void *value, size_t val_len)
+{
+   int rc;
+
+   if (TestRadioContext()->state->radioMode != SX126X_HAL_RADIO_SLEEP)
+   {
+      saveOverlaps++;
+   }
+
+   rc = __real_settings_save_one(name, value, val_len);
+
+   if (TestRadioContext()->state->radioMode != SX126X_HAL_RADIO_SLEEP)
+   {
+      saveOverlaps++;
+   }
+
+   if (saveCount++ == 0)
+   {
+      firstSaveMs = k_uptime_get();
+   }
+
+   return rc;
+}
+
+static void RxWindowOpen(void)
+{
+   const uint8_t command[] = {OPCODE_SET_RX, RX_TIMEOUT_CONTINUOUS, RX_TIMEOUT_CONTINUOUS, RX_TIMEOUT_CONTINUOUS};
+
+   zassert_equal(sx126x_hal_write(TestRadioContext(), command, sizeof(command), NULL, 0), SX126X_HAL_STATUS_OK);
+}
+
+static void RxWindowClose(void)
+{
+   const uint8_t command[] = {OPCODE_SET_SLEEP, SLEEP_CFG_WARM_START};
+
+   zassert_equal(sx126x_hal_write(TestRadioContext(), command, sizeof(command), NULL, 0), SX126X_HAL_STATUS_OK);
+}
+
+/**
+ * @brief Store a new modem context, left to the deferred flush.
+ */
+static void ContextStoreNew(void)
+{
+   contextData[0]++;
+   smtc_modem_hal_context_store(CONTEXT_MODEM, contextData, sizeof(contextData));
+}
+
+static void *FlashSchedSetup(void)
+{
+   zassert_equal(sx126x_hal_reset(TestRadioContext()), SX126X_HAL_STATUS_OK, "Radio reset");
+
+   return NULL;
+}
+
+static void FlashSchedBefore(void *fixture)
+{
+   // Keep BUSY low, so the test thread only yields in its sleeps.
+   sx126x_emul_set_timing(TestRadioEmul(), 0, CONFIG_LBM_RADIO_HAL_EMUL_RX_DELAY_US);
+   RxWindowClose();
+   smtc_modem_hal_context_flush();
+
+   // The flush work runs when the test thread sleeps, as when the modem thread
+   // waits for its next task.
+   testPriority = k_thread_priority_get(k_current_get());
+   k_thread_priority_set(k_current_get(), K_PRIO_COOP(1));
+
+   saveCount = 0;
+   saveOverlaps = 0;
+}
+
+static void FlashSchedAfter(void *fixture)
+{
+   k_thread_priority_set(k_current_get(), testPriority);
+   sx126x_emul_set_timing(TestRadioEmul(), CONFIG_LBM_RADIO_HAL_EMUL_BUSY_US, CONFIG_LBM_RADIO_HAL_EMUL_RX_DELAY_US);
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- TESTS -------------------------------------------------------------------
+ */
+
+ZTEST(modem_hal_flash_sched, test_no_write_in_rx_window)
+{
+   smtc_modem_hal_context_stats_t before;
+   smtc_modem_hal_context_stats_t after;
+
+   smtc_modem_hal_context_stats_get(&before);
+   ContextStoreNew();
+
+   // An idle time is reported, but the modem opens an RX window before the
+   // flush runs.
+   smtc_modem_hal_flash_idle(IDLE_GAP_MS);
+   RxWindowOpen();
+   k_msleep(RX_WINDOW_MS);
+   RxWindowClose();
+   zassert_equal(saveCount, 0, "Context written in the RX window");
+
+   for (uint32_t i = 0; (i < MODEM_CYCLES) && (saveCount == 0); i++)
+   {
+      smtc_modem_hal_flash_idle(IDLE_GAP_MS);
+      k_msleep(IDLE_GAP_MS);
+      RxWindowOpen();
+      k_msleep(RX_WINDOW_MS);
+      RxWindowClose();
+   }
+
+   smtc_modem_hal_context_stats_get(&after);
+   zassert_equal(saveCount, 1, "Context written %u times", saveCount);
+   zassert_equal(saveOverlaps, 0, "Context written in an RX window");
+   zassert_equal(after.idleFlushes - before.idleFlushes, 1);
+   zassert_equal(after.missedDeadlines - before.missedDeadlines, 0);
+}
+
+ZTEST(modem_hal_flash_sched, test_write_at_deadline)
+{
+   smtc_modem_hal_context_stats_t before;
+   smtc_modem_hal_context_stats_t after;
+   int64_t storeMs;
+
+   smtc_modem_hal_context_stats_get(&before);
+   storeMs = k_uptime_get();
+   ContextStoreNew();
+
+   // The idle time ends before the flush runs, and none is reported after.
+   smtc_modem_hal_flash_idle(IDLE_GAP_MS);
+   RxWindowOpen();
+   k_msleep(RX_WINDOW_MS);
+   RxWindowClose();
+
+   for (uint32_t i = 0; (i < MODEM_CYCLES) && (saveCount == 0); i++)
+   {
+      k_msleep(IDLE_GAP_MS);
+      RxWindowOpen();
+      k_msleep(RX_WINDOW_MS);
+      RxWindowClose();
+   }
+
+   smtc_modem_hal_context_stats_get(&after);
+   zassert_equal(saveCount, 1, "Context written %u times", saveCount);
+   zassert_true(firstSaveMs - storeMs >= CONFIG_LBM_MODEM_HAL_CONTEXT_FLUSH_DELAY_MS,
+                "Context written %d ms after the store, before the deadline", (int32_t) (firstSaveMs - storeMs));
+   zassert_equal(after.missedDeadlines - before.missedDeadlines, 1);
+}
+
+ZTEST_SUITE(modem_hal_flash_sched, NULL, FlashSchedSetup, FlashSchedBefore, FlashSchedAfter, NULL);
@@ -0,0 +1,214 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Tests of the radio IRQ timestamp of the modem HAL.
+*
+* @details  The DIO1 callback runs on the modem work queue, possibly long after
+*           the interrupt. The timestamp it reads must still be the time the
+*           interrupt was raised, latched by the interrupt handler.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/ztest.h>
+
+#include "smtc_modem_hal.h"
+#include "sx126x_hal.h"
+#include "modem_hal_test.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+// Time the callback of the first interrupt keeps the work queue busy.
+#define CALLBACK_BUSY_MS            10
+
+// Delay between two interrupts, shorter than the busy callback.
+#define IRQ_INTERVAL_MS             3
+
+// Timestamp resolution, 100 us.
+#define TIMESTAMP_TOLERANCE         1
+
+#define IRQ_COUNT_MAX               4
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static struct k_sem           callbackSem;
+static uint32_t               callbackCount;
+static uint32_t               callbackTimestamps[IRQ_COUNT_MAX];
+static uint32_t               callbackTimes[IRQ_COUNT_MAX];
+static uint32_t               callbackBusyMs;
+
+static struct k_timer         secondIrqTimer;
+static volatile uint32_t      secondIrqTime;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief DIO1 callback, as the radio planner: reads the IRQ timestamp late.
+ */
+static void RadioIrqCallback(void *context)
+{
+   const uint32_t index = MIN(callbackCount, IRQ_COUNT_MAX - 1);
+
+   // Keep the work queue busy, as a long radio planner pass.
+   if ((callbackCount == 0) && (callbackBusyMs > 0))
+   {
+      k_busy_wait(callbackBusyMs * USEC_PER_MSEC);
+   }
+
+   callbackTimestamps[index] = smtc_modem_hal_get_radio_irq_timestamp_in_100us();
+   callbackTimes[index] = smtc_modem_hal_get_time_in_100us();
+   callbackCount++;
+   k_sem_give(&callbackSem);
+}
+
+/**
+ * @brief Raise the DIO1 interrupt of the emulated radio.
+ *
+ * @return Time of the interrupt.
+ */
+static uint32_t RaiseDio1(void)
+{
+   const struct gpio_dt_spec *dio1 = &TestRadioContext()->gpioDio1;
+   uint32_t irqTime = smtc_modem_hal_get_time_in_100us();
+
+   gpio_emul_input_set(dio1->port, dio1->pin, 1);
+   gpio_emul_input_set(dio1->port, dio1->pin, 0);
+
+   return irqTime;
+}
+
+/**
+ * @brief Raise a DIO1 interrupt from a timer interrupt.
+ */
+static void SecondIrqTimerHandler(struct k_timer *timer)
+{
+   secondIrqTime = RaiseDio1();
+}
+
+static void *IrqTimestampSetup(void)
+{
+   zassert_equal(sx126x_hal_reset(TestRadioContext()), SX126X_HAL_STATUS_OK, "Radio reset");
+   k_sem_init(&callbackSem, 0, IRQ_COUNT_MAX);
+   k_timer_init(&secondIrqTimer, SecondIrqTimerHandler, NULL);
+   smtc_modem_hal_irq_config_radio_irq(RadioIrqCallback, NULL);
+
+   return NULL;
+}
+
+static void IrqTimestampBefore(void *fixture)
+{
+   k_sem_reset(&callbackSem);
+   callbackCount = 0;
+   callbackBusyMs = 0;
+   smtc_modem_hal_enable_modem_irq();
+}
+
+static void IrqTimestampAfter(void *fixture)
+{
+   smtc_modem_hal_disable_modem_irq();
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- TESTS -------------------------------------------------------------------
+ */
+
+ZTEST(modem_hal_irq_timestamp, test_latched_by_interrupt)
+{
+   uint32_t irqTime;
+
+   irqTime = RaiseDio1();
+   zassert_equal(k_sem_take(&callbackSem, K_MSEC(100)), 0, "No DIO1 callback");
+   zassert_within(callbackTimestamps[0], irqTime, TIMESTAMP_TOLERANCE,
+                  "Timestamp %u, interrupt at %u", callbackTimestamps[0], irqTime);
+}
+
+ZTEST(modem_hal_irq_timestamp, test_late_callback)
+{
+   uint32_t irqTime;
+
+   // The first callback reads the timestamp only after keeping the work queue busy.
+   callbackBusyMs = CALLBACK_BUSY_MS;
+   irqTime = RaiseDio1();
+   zassert_equal(k_sem_take(&callbackSem, K_MSEC(100)), 0, "No DIO1 callback");
+
+   zassert_true(callbackTimes[0] - irqTime >= CALLBACK_BUSY_MS * 10, "Callback not delayed");
+   zassert_within(callbackTimestamps[0], irqTime, TIMESTAMP_TOLERANCE,
+                  "Timestamp %u is the callback time, interrupt at %u", callbackTimestamps[0], irqTime);
+}
+
+ZTEST(modem_hal_irq_timestamp, test_interrupt_queued_behind_busy_work)
+{
+   uint32_t firstIrqTime;
+
+   // The second interrupt comes from a timer, while the work queue still runs the
+   // first callback.
+   callbackBusyMs = CALLBACK_BUSY_MS;
+   k_timer_start(&secondIrqTimer, K_MSEC(IRQ_INTERVAL_MS), K_NO_WAIT);
+   firstIrqTime = RaiseDio1();
+
+   zassert_equal(k_sem_take(&callbackSem, K_MSEC(100)), 0, "No first DIO1 callback");
+   zassert_equal(k_sem_take(&callbackSem, K_MSEC(100)), 0, "No second DIO1 callback");
+   zassert_equal(callbackCount, 2);
+
+   zassert_true(secondIrqTime - firstIrqTime >= IRQ_INTERVAL_MS * 10);
+   zassert_true(callbackTimes[0] > secondIrqTime, "Second interrupt after the first callback");
+   zassert_within(callbackTimestamps[0], secondIrqTime, TIMESTAMP_TOLERANCE,
+                  "First callback: timestamp %u, last interrupt at %u", callbackTimestamps[0], secondIrqTime);
+   zassert_within(callbackTimestamps[1], secondIrqTime, TIMESTAMP_TOLERANCE,
+                  "Second callback: timestamp %u, interrupt at %u", callbackTimestamps[1], secondIrqTime);
+}
+
+ZTEST(modem_hal_irq_timestamp, test_disabled_irq_not_latched)
+{
+   uint32_t irqTime;
+   uint32_t timestamp;
+
+   irqTime = RaiseDio1();
+   zassert_equal(k_sem_take(&callbackSem, K_MSEC(100)), 0, "No DIO1 callback");
+
+   // A masked interrupt doesn't move the timestamp.
+   smtc_modem_hal_disable_modem_irq();
+   k_msleep(IRQ_INTERVAL_MS);
+   RaiseDio1();
+   zassert_equal(k_sem_take(&callbackSem, K_MSEC(20)), -EAGAIN, "Callback of a masked interrupt");
+
+   timestamp = smtc_modem_hal_get_radio_irq_timestamp_in_100us();
+   zassert_within(timestamp, irqTime, TIMESTAMP_TOLERANCE, "Timestamp %u, interrupt at %u", timestamp, irqTime);
+}
+
+ZTEST(modem_hal_irq_timestamp, test_clear_pending_keeps_irq_state)
+{
+   // Enabled: still raised after the clear.
+   smtc_modem_hal_radio_irq_clear_pending();
+   RaiseDio1();
+   zassert_equal(k_sem_take(&callbackSem, K_MSEC(100)), 0, "No DIO1 callback after a clear");
+
+   // Disabled: the clear doesn't enable it again.
+   smtc_modem_hal_disable_modem_irq();
+   smtc_modem_hal_radio_irq_clear_pending();
+   RaiseDio1();
+   zassert_equal(k_sem_take(&callbackSem, K_MSEC(20)), -EAGAIN, "Callback of a masked interrupt");
+}
+
+ZTEST_SUITE(modem_hal_irq_timestamp, NULL, IrqTimestampSetup, IrqTimestampBefore, IrqTimestampAfter, NULL);
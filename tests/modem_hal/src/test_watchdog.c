@@ -0,0 +1,140 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Tests of the modem engine watchdog and supervisor.
+*
+* @details  Built in the lbm.modem_hal.watchdog scenario, with a short
+*           watchdog timeout. The MCU reset is observed by wrapping
+*           SmtcModemHalPlatformReset() at link time.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_ext.h"
+
+#if defined(CONFIG_LBM_MODEM_HAL_WATCHDOG)
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define ENGINE_BUDGET_MS            CONFIG_LBM_MODEM_HAL_SUPERVISOR_ENGINE_BUDGET_MS
+#define WATCHDOG_TIMEOUT_MS         CONFIG_LBM_MODEM_HAL_WATCHDOG_TIMEOUT_MS
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static K_SEM_DEFINE(resetSem, 0, 1);
+static volatile uint32_t      resetCount;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/**
+ * @brief MCU reset of the modem HAL, counted instead.
+ */
+void __wrap_SmtcModemHalPlatformReset(void)
+{
+   resetCount++;
+   k_sem_give(&resetSem);
+}
+
+static void WatchdogBefore(void *fixture)
+{
+   // The other suites don't feed the watchdog.
+   smtc_modem_hal_reload_wdog();
+   k_sem_reset(&resetSem);
+   resetCount = 0;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- TESTS -------------------------------------------------------------------
+ */
+
+ZTEST(modem_hal_watchdog, test_engine_passes_feed_the_watchdog)
+{
+   smtc_modem_hal_supervisor_stats_t before;
+   smtc_modem_hal_supervisor_stats_t after;
+   const uint32_t passes = 2 * WATCHDOG_TIMEOUT_MS / (ENGINE_BUDGET_MS / 2);
+
+   smtc_modem_hal_supervisor_stats_get(SMTC_MODEM_HAL_SUPERVISOR_ENGINE, &before);
+
+   // Short passes, for twice the watchdog timeout.
+   for (uint32_t i = 0; i < passes; i++)
+   {
+      const uint32_t start = smtc_modem_hal_supervisor_begin(SMTC_MODEM_HAL_SUPERVISOR_ENGINE);
+
+      k_msleep(ENGINE_BUDGET_MS / 2);
+      smtc_modem_hal_supervisor_end(SMTC_MODEM_HAL_SUPERVISOR_ENGINE, start);
+   }
+
+   smtc_modem_hal_supervisor_stats_get(SMTC_MODEM_HAL_SUPERVISOR_ENGINE, &after);
+   zassert_equal(after.count - before.count, passes);
+   zassert_equal(after.overruns, before.overruns, "Pass in budget counted as an overrun");
+   zassert_equal(resetCount, 0, "Watchdog tripped on a running engine");
+}
+
+ZTEST(modem_hal_watchdog, test_stalled_engine)
+{
+   smtc_modem_hal_supervisor_stats_t before;
+   smtc_modem_hal_supervisor_stats_t after;
+   int64_t stallStartMs;
+   int64_t resetMs;
+   uint32_t start;
+
+   smtc_modem_hal_supervisor_stats_get(SMTC_MODEM_HAL_SUPERVISOR_ENGINE, &before);
+
+   // The engine pass stalls, without feeding the watchdog.
+   stallStartMs = k_uptime_get();
+   start = smtc_modem_hal_supervisor_begin(SMTC_MODEM_HAL_SUPERVISOR_ENGINE);
+   zassert_equal(k_sem_take(&resetSem, K_MSEC(2 * WATCHDOG_TIMEOUT_MS)), 0, "Watchdog didn't trip");
+   resetMs = k_uptime_get();
+   smtc_modem_hal_supervisor_end(SMTC_MODEM_HAL_SUPERVISOR_ENGINE, start);
+
+   smtc_modem_hal_supervisor_stats_get(SMTC_MODEM_HAL_SUPERVISOR_ENGINE, &after);
+   zassert_equal(resetCount, 1);
+   zassert_true(resetMs - stallStartMs >= WATCHDOG_TIMEOUT_MS, "Reset %d ms after the stall",
+                (int32_t) (resetMs - stallStartMs));
+   zassert_equal(after.overruns - before.overruns, 1, "Stall not counted as an overrun");
+   zassert_true(after.maxUs >= WATCHDOG_TIMEOUT_MS * USEC_PER_MSEC, "Longest pass %u us", after.maxUs);
+}
+
+ZTEST(modem_hal_watchdog, test_slow_event_callback)
+{
+   smtc_modem_hal_supervisor_stats_t before;
+   smtc_modem_hal_supervisor_stats_t after;
+   uint32_t start;
+
+   smtc_modem_hal_supervisor_stats_get(SMTC_MODEM_HAL_SUPERVISOR_EVENT, &before);
+
+   start = smtc_modem_hal_supervisor_begin(SMTC_MODEM_HAL_SUPERVISOR_EVENT);
+   k_msleep(CONFIG_LBM_MODEM_HAL_SUPERVISOR_EVENT_BUDGET_MS + 1);
+   smtc_modem_hal_supervisor_end(SMTC_MODEM_HAL_SUPERVISOR_EVENT, start);
+
+   smtc_modem_hal_supervisor_stats_get(SMTC_MODEM_HAL_SUPERVISOR_EVENT, &after);
+   zassert_equal(after.overruns - before.overruns, 1, "Slow callback not counted as an overrun");
+   zassert_equal(resetCount, 0);
+}
+
+ZTEST_SUITE(modem_hal_watchdog, NULL, NULL, WatchdogBefore, NULL, NULL);
+
+#endif
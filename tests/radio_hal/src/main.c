@@ -0,0 +1,365 @@
+/*********************************************************************
+* COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF EXPONENTIAL
+* TECHNOLOGY GROUP.
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+*******************************************************************************
+* @file
+* @brief  Tests of the SX126x radio HAL with two emulated radios.
+*
+* @details  Each radio of the board has its own HAL state: sleep mode, BUSY
+*           interrupt, configuration shadow and start-up latencies. The tests
+*           drive the two radios of boards/native_sim.overlay, from one or two
+*           threads, and check that nothing leaks from one radio to the other.
+******************************************************************************/
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/ztest.h>
+
+#include "ralf.h"
+#include "smtc_board_ralf.h"
+#include "sx126x_hal.h"
+#include "sx126x_hal_context.h"
+#include "sx126x_emul.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define RADIO_COUNT                 2
+
+#define OPCODE_WRITE_BUFFER         0x0E
+#define OPCODE_READ_BUFFER          0x1E
+#define OPCODE_SET_STANDBY          0x80
+#define OPCODE_SET_TX               0x83
+#define OPCODE_SET_SLEEP            0x84
+#define OPCODE_SET_RF_FREQUENCY     0x86
+#define OPCODE_SET_PKT_TYPE         0x8A
+#define OPCODE_SET_MODULATION_PARAMS 0x8B
+#define OPCODE_SET_PKT_PARAMS       0x8C
+
+#define SLEEP_CFG_WARM_START        0x04
+#define PKT_TYPE_LORA               0x01
+
+// Buffer transfers of each thread in the concurrent test.
+#define TRANSFER_SIZE               32
+#define TRANSFER_COUNT              200
+
+// BUSY time of the slow radio, and longest command allowed on the other one.
+#define SLOW_BUSY_US                20000
+#define SLOW_COMMANDS               5
+#define FAST_COMMAND_MAX_US         2000
+
+#define WORKER_STACK_SIZE           2048
+#define WORKER_PRIORITY             5
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct
+{
+   uint32_t index;
+   uint32_t errors;
+} Worker_t;
+
+typedef struct
+{
+   uint32_t count;
+   uint8_t  size;
+   uint8_t  firstByte;
+   struct k_sem done;
+} TxRecord_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+// Radios and emulators, by SPI chip select.
+static const sx126x_hal_context_t *radios[RADIO_COUNT];
+static const struct emul *const radioEmuls[RADIO_COUNT] = {
+   EMUL_DT_GET(DT_NODELABEL(lora0)),
+   EMUL_DT_GET(DT_NODELABEL(lora1)),
+};
+
+static K_THREAD_STACK_ARRAY_DEFINE(workerStacks, RADIO_COUNT, WORKER_STACK_SIZE);
+static struct k_thread        workerThreads[RADIO_COUNT];
+static Worker_t               workers[RADIO_COUNT];
+
+static TxRecord_t             txRecords[RADIO_COUNT];
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void WriteCommand(uint32_t radio, const uint8_t *command, uint16_t length)
+{
+   zassert_equal(sx126x_hal_write(radios[radio], command, length, NULL, 0), SX126X_HAL_STATUS_OK,
+                 "Radio %u write 0x%02x", radio, command[0]);
+}
+
+static uint32_t ShadowElided(uint32_t radio)
+{
+   uint32_t commands;
+   uint32_t bytes;
+
+   sx126x_hal_shadow_stats_get(radios[radio], &commands, &bytes);
+   return commands;
+}
+
+/**
+ * @brief Write and read back the data buffer of a radio, with a pattern of its own.
+ */
+static void BufferWorker(void *p1, void *p2, void *p3)
+{
+   Worker_t *worker = p1;
+   const void *radio = radios[worker->index];
+   uint8_t written[TRANSFER_SIZE];
+   uint8_t read[TRANSFER_SIZE];
+
+   for (uint32_t i = 0; i < TRANSFER_COUNT; i++)
+   {
+      const uint8_t writeCommand[] = {OPCODE_WRITE_BUFFER, 0};
+      const uint8_t readCommand[] = {OPCODE_READ_BUFFER, 0, 0};
+
+      for (uint32_t j = 0; j < sizeof(written); j++)
+      {
+         written[j] = (uint8_t) ((worker->index << 7) | ((i + j) & 0x7F));
+      }
+      memset(read, 0, sizeof(read));
+
+      if ((sx126x_hal_write(radio, writeCommand, sizeof(writeCommand), written, sizeof(written)) !=
+           SX126X_HAL_STATUS_OK) ||
+          (sx126x_hal_read(radio, readCommand, sizeof(readCommand), read, sizeof(read)) !=
+           SX126X_HAL_STATUS_OK) ||
+          (memcmp(written, read, sizeof(read)) != 0))
+      {
+         worker->errors++;
+      }
+   }
+}
+
+/**
+ * @brief Send commands to a slow radio, checking that each one waits on its BUSY.
+ */
+static void SlowWorker(void *p1, void *p2, void *p3)
+{
+   Worker_t *worker = p1;
+   const sx126x_hal_context_t *radio = radios[worker->index];
+   const uint8_t standbyCommand[] = {OPCODE_SET_STANDBY, 0};
+
+   for (uint32_t i = 0; i < SLOW_COMMANDS; i++)
+   {
+      if (sx126x_hal_write(radio, standbyCommand, sizeof(standbyCommand), NULL, 0) != SX126X_HAL_STATUS_OK)
+      {
+         worker->errors++;
+      }
+      else if ((i > 0) && (radio->state->busyLastWaitUs < SLOW_BUSY_US / 2))
+      {
+         worker->errors++;
+      }
+   }
+}
+
+static void TxDone(const struct emul *target, const uint8_t *payload, uint8_t size, uint32_t freqHz,
+                   void *userData)
+{
+   TxRecord_t *record = userData;
+
+   record->count++;
+   record->size = size;
+   record->firstByte = payload[0];
+   k_sem_give(&record->done);
+}
+
+static void *RadioHalSetup(void)
+{
+   zassert_equal(smtc_board_get_ralf_count(), RADIO_COUNT, "Radios of the board");
+
+   for (uint32_t i = 0; i < RADIO_COUNT; i++)
+   {
+      const ralf_t *ralf = smtc_board_get_ralf_by_index(i);
+      const sx126x_hal_context_t *context;
+
+      zassert_not_null(ralf, "Radio %u", i);
+      context = ralf->ral.context;
+      zassert_true(context->spiSpec.config.slave < RADIO_COUNT, "Radio %u chip select", i);
+      radios[context->spiSpec.config.slave] = context;
+   }
+
+   zassert_not_null(radios[0]);
+   zassert_not_null(radios[1]);
+   zassert_not_equal(radios[0]->state, radios[1]->state, "Shared radio state");
+
+   return NULL;
+}
+
+static void RadioHalBefore(void *fixture)
+{
+   for (uint32_t i = 0; i < RADIO_COUNT; i++)
+   {
+      sx126x_emul_set_timing(radioEmuls[i], CONFIG_LBM_RADIO_HAL_EMUL_BUSY_US, CONFIG_LBM_RADIO_HAL_EMUL_RX_DELAY_US);
+      sx126x_emul_set_tx_callback(radioEmuls[i], NULL, NULL);
+      zassert_equal(sx126x_hal_reset(radios[i]), SX126X_HAL_STATUS_OK, "Radio %u reset", i);
+   }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- TESTS -------------------------------------------------------------------
+ */
+
+ZTEST(radio_hal_multi, test_sleep_is_per_radio)
+{
+   const uint8_t sleepCommand[] = {OPCODE_SET_SLEEP, SLEEP_CFG_WARM_START};
+   const uint8_t standbyCommand[] = {OPCODE_SET_STANDBY, 0};
+   sx126x_hal_wake_stats_t before[RADIO_COUNT];
+   sx126x_hal_wake_stats_t after[RADIO_COUNT];
+
+   for (uint32_t i = 0; i < RADIO_COUNT; i++)
+   {
+      sx126x_hal_wake_stats_get(radios[i], SX126X_HAL_WAKE_WARM, &before[i]);
+   }
+
+   WriteCommand(0, sleepCommand, sizeof(sleepCommand));
+   zassert_equal(radios[0]->state->radioMode, SX126X_HAL_RADIO_SLEEP);
+   zassert_equal(radios[1]->state->radioMode, SX126X_HAL_RADIO_AWAKE);
+
+   // A command to the other radio doesn't wake this one up.
+   WriteCommand(1, standbyCommand, sizeof(standbyCommand));
+   zassert_equal(radios[0]->state->radioMode, SX126X_HAL_RADIO_SLEEP);
+
+   zassert_equal(sx126x_hal_wakeup(radios[0]), SX126X_HAL_STATUS_OK);
+   zassert_equal(radios[0]->state->radioMode, SX126X_HAL_RADIO_AWAKE);
+   zassert_equal(sx126x_hal_last_wake_get(radios[0]), SX126X_HAL_WAKE_WARM);
+   zassert_equal(sx126x_hal_last_wake_get(radios[1]), SX126X_HAL_WAKE_RESET);
+
+   for (uint32_t i = 0; i < RADIO_COUNT; i++)
+   {
+      sx126x_hal_wake_stats_get(radios[i], SX126X_HAL_WAKE_WARM, &after[i]);
+   }
+   zassert_equal(after[0].count, before[0].count + 1, "Warm start of radio 0");
+   zassert_equal(after[1].count, before[1].count, "Warm start counted on radio 1");
+}
+
+ZTEST(radio_hal_multi, test_shadow_is_per_radio)
+{
+   // 868 MHz.
+   const uint8_t frequencyCommand[] = {OPCODE_SET_RF_FREQUENCY, 0x36, 0x40, 0x00, 0x00};
+   const uint32_t elided0 = ShadowElided(0);
+   const uint32_t elided1 = ShadowElided(1);
+
+   if (!IS_ENABLED(CONFIG_LBM_RADIO_HAL_SHADOW))
+   {
+      ztest_test_skip();
+   }
+
+   WriteCommand(0, frequencyCommand, sizeof(frequencyCommand));
+   WriteCommand(0, frequencyCommand, sizeof(frequencyCommand));
+   zassert_equal(ShadowElided(0), elided0 + 1, "Repeated command not skipped");
+
+   // The same configuration is new to the other radio.
+   WriteCommand(1, frequencyCommand, sizeof(frequencyCommand));
+   zassert_equal(ShadowElided(1), elided1, "Command skipped on the other radio");
+
+   // Resetting one radio only forgets its own configuration.
+   zassert_equal(sx126x_hal_reset(radios[1]), SX126X_HAL_STATUS_OK);
+   WriteCommand(0, frequencyCommand, sizeof(frequencyCommand));
+   zassert_equal(ShadowElided(0), elided0 + 2, "Reset of radio 1 cleared radio 0");
+}
+
+ZTEST(radio_hal_multi, test_concurrent_buffers)
+{
+   for (uint32_t i = 0; i < RADIO_COUNT; i++)
+   {
+      workers[i].index = i;
+      workers[i].errors = 0;
+      k_thread_create(&workerThreads[i], workerStacks[i], K_THREAD_STACK_SIZEOF(workerStacks[i]),
+                      BufferWorker, &workers[i], NULL, NULL, WORKER_PRIORITY, 0, K_NO_WAIT);
+   }
+
+   for (uint32_t i = 0; i < RADIO_COUNT; i++)
+   {
+      zassert_equal(k_thread_join(&workerThreads[i], K_SECONDS(10)), 0, "Radio %u worker stuck", i);
+      zassert_equal(workers[i].errors, 0, "Radio %u: %u bad transfers", i, workers[i].errors);
+   }
+}
+
+ZTEST(radio_hal_multi, test_busy_is_per_radio)
+{
+   const uint8_t standbyCommand[] = {OPCODE_SET_STANDBY, 0};
+   uint32_t maxUs = 0;
+
+   // Radio 1 stays busy for a long time after each command.
+   sx126x_emul_set_timing(radioEmuls[1], SLOW_BUSY_US, CONFIG_LBM_RADIO_HAL_EMUL_RX_DELAY_US);
+   workers[1].index = 1;
+   workers[1].errors = 0;
+   k_thread_create(&workerThreads[1], workerStacks[1], K_THREAD_STACK_SIZEOF(workerStacks[1]),
+                   SlowWorker, &workers[1], NULL, NULL, WORKER_PRIORITY, 0, K_NO_WAIT);
+
+   // Radio 0 commands don't wait on the BUSY of radio 1.
+   for (uint32_t i = 0; i < SLOW_COMMANDS * 4; i++)
+   {
+      const uint32_t startCycles = k_cycle_get_32();
+
+      WriteCommand(0, standbyCommand, sizeof(standbyCommand));
+      maxUs = MAX(maxUs, k_cyc_to_us_ceil32(k_cycle_get_32() - startCycles));
+      k_sleep(K_USEC(SLOW_BUSY_US / 4));
+   }
+
+   zassert_equal(k_thread_join(&workerThreads[1], K_SECONDS(2)), 0, "Radio 1 worker stuck");
+   zassert_equal(workers[1].errors, 0, "Radio 1 didn't wait on its BUSY");
+   zassert_true(maxUs < FAST_COMMAND_MAX_US, "Radio 0 command took %u us", maxUs);
+}
+
+ZTEST(radio_hal_multi, test_tx_on_own_radio)
+{
+   const uint8_t packetTypeCommand[] = {OPCODE_SET_PKT_TYPE, PKT_TYPE_LORA};
+   // SF7, BW 125 kHz, CR 4/5.
+   const uint8_t modulationCommand[] = {OPCODE_SET_MODULATION_PARAMS, 0x07, 0x04, 0x01, 0x00};
+   // Preamble of 8 symbols, explicit header, 4 bytes, CRC on, standard IQ.
+   const uint8_t packetCommand[] = {OPCODE_SET_PKT_PARAMS, 0x00, 0x08, 0x00, 0x04, 0x01, 0x00};
+   const uint8_t txCommand[] = {OPCODE_SET_TX, 0x00, 0x00, 0x00};
+
+   for (uint32_t i = 0; i < RADIO_COUNT; i++)
+   {
+      memset(&txRecords[i], 0, sizeof(txRecords[i]));
+      k_sem_init(&txRecords[i].done, 0, 1);
+      sx126x_emul_set_tx_callback(radioEmuls[i], TxDone, &txRecords[i]);
+   }
+
+   for (uint32_t i = 0; i < RADIO_COUNT; i++)
+   {
+      const uint8_t writeCommand[] = {OPCODE_WRITE_BUFFER, 0};
+      const uint8_t payload[4] = {(uint8_t) (0xA0 + i), 1, 2, 3};
+
+      WriteCommand(i, packetTypeCommand, sizeof(packetTypeCommand));
+      WriteCommand(i, modulationCommand, sizeof(modulationCommand));
+      WriteCommand(i, packetCommand, sizeof(packetCommand));
+      zassert_equal(sx126x_hal_write(radios[i], writeCommand, sizeof(writeCommand), payload, sizeof(payload)),
+                    SX126X_HAL_STATUS_OK);
+   }
+
+   // Only radio 1 transmits.
+   WriteCommand(1, txCommand, sizeof(txCommand));
+   zassert_equal(k_sem_take(&txRecords[1].done, K_SECONDS(1)), 0, "No TX on radio 1");
+   zassert_equal(txRecords[1].count, 1);
+   zassert_equal(txRecords[1].size, 4);
+   zassert_equal(txRecords[1].firstByte, 0xA1, "Radio 1 sent the payload of radio 0");
+   zassert_equal(k_sem_take(&txRecords[0].done, K_MSEC(100)), -EAGAIN, "TX on radio 0");
+}
+
+ZTEST_SUITE(radio_hal_multi, NULL, RadioHalSetup, RadioHalBefore, NULL, NULL);
@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+#
+# COPYRIGHT 2023 CONNECTED DEVELOPMENT, A DIVISION OF
+# EXPONENTIAL TECHNOLOGY GROUP.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Decode a SX126x radio HAL SPI trace (CONFIG_LBM_RADIO_HAL_TRACE).
+
+The input is either the raw binary content of the sx126x_hal_trace symbol,
+dumped with a debugger, or a console log containing the "SXTR:" lines printed
+by sx126x_hal_trace_dump().
+
+Examples:
+    sx126x_trace_decode.py console.log
+    sx126x_trace_decode.py --binary trace.bin
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+TRACE_MAGIC = 0x52545853
+TRACE_VERSION = 1
+
+HEADER_FORMAT = "<IHHHHII"
+RECORD_FORMAT = "<IBBHHHH"
+
+FLAG_READ = 0x01
+FLAG_ELIDED = 0x02
+FLAG_ERROR = 0x04
+
+# Command names, read from SX126X_CMD_LIST of the radio HAL.
+RADIO_HAL_SOURCE = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                "..", "RadioDriverHAL", "sx126x_hal.c")
+OPCODES = {}
+
+
+def load_opcodes(path):
+    """Read the X(name, opcode) entries of SX126X_CMD_LIST from the radio HAL source."""
+    with open(path, "r") as f:
+        source = f.read()
+    match = re.search(r"#define SX126X_CMD_LIST\(X\)(.*?)\n\n", source, re.S)
+    if match is None:
+        sys.exit("no SX126X_CMD_LIST in %s" % path)
+    return {int(opcode, 16): name
+            for name, opcode in re.findall(r"X\((\w+),\s*(0x[0-9A-Fa-f]+)\)", match.group(1))}
+
+
+def opcode_name(opcode):
+    return OPCODES.get(opcode, "UNKNOWN_0x%02X" % opcode)
+
+
+def flags_str(flags):
+    out = "R" if flags & FLAG_READ else "W"
+    out += "S" if flags & FLAG_ELIDED else "-"
+    out += "E" if flags & FLAG_ERROR else "-"
+    return out
+
+
+def read_console(path):
+    """Extract the binary trace from the SXTR: lines of a console log."""
+    data = bytearray()
+    started = False
+    with open(path, "r", errors="replace") as f:
+        for line in f:
+            idx = line.find("SXTR:")
+            if idx < 0:
+                continue
+            payload = line[idx + 5:].strip()
+            if payload.startswith("BEGIN"):
+                # Keep the last dump only.
+                data = bytearray()
+                started = True
+            elif payload.startswith("END"):
+                started = False
+            elif started:
+                data += bytes.fromhex(payload)
+    return bytes(data)
+
+
+def parse(data):
+    header_size = struct.calcsize(HEADER_FORMAT)
+    if len(data) < header_size:
+        sys.exit("trace too short")
+
+    magic, version, record_size, record_count, payload_size, cycles_per_sec, head = \
+        struct.unpack_from(HEADER_FORMAT, data, 0)
+    if magic != TRACE_MAGIC:
+        sys.exit("bad trace magic 0x%08X" % magic)
+    if version != TRACE_VERSION:
+        sys.exit("unsupported trace version %d" % version)
+
+    fixed_size = struct.calcsize(RECORD_FORMAT)
+    if record_size != fixed_size + payload_size:
+        sys.exit("inconsistent record size %d" % record_size)
+    if len(data) < header_size + record_size * record_count:
+        sys.exit("trace truncated")
+
+    # Oldest record first.
+    count = min(head, record_count)
+    first = head - count
+    records = []
+    for n in range(first, head):
+        offset = header_size + (n % record_count) * record_size
+        cycles, opcode, flags, cmd_len, data_len, busy_us, duration_us = \
+            struct.unpack_from(RECORD_FORMAT, data, offset)
+        payload = data[offset + fixed_size:offset + record_size]
+        used = min(payload_size, max(cmd_len - 1, 0) + data_len)
+        records.append({
+            "index": n,
+            "cycles": cycles,
+            "opcode": opcode,
+            "flags": flags,
+            "cmd_len": cmd_len,
+            "data_len": data_len,
+            "busy_us": busy_us,
+            "duration_us": duration_us,
+            "payload": payload[:used],
+        })
+
+    return cycles_per_sec, head, records
+
+
+def percentile(values, pct):
+    values = sorted(values)
+    return values[min(len(values) - 1, (len(values) * pct) // 100)]
+
+
+def print_timeline(records, cycles_per_sec):
+    print("%8s %12s %-4s %-28s %5s %5s %8s %8s  %s" %
+          ("#", "time_us", "flag", "command", "clen", "dlen", "busy_us", "dur_us", "payload"))
+
+    elapsed = 0
+    previous = None
+    for rec in records:
+        # The 32-bit cycle counter wraps, accumulate the deltas.
+        if previous is not None:
+            elapsed += (rec["cycles"] - previous) & 0xFFFFFFFF
+        previous = rec["cycles"]
+        time_us = elapsed * 1000000 // cycles_per_sec
+
+        print("%8d %12d %-4s %-28s %5d %5d %8d %8d  %s" %
+              (rec["index"], time_us, flags_str(rec["flags"]), opcode_name(rec["opcode"]),
+               rec["cmd_len"], rec["data_len"], rec["busy_us"], rec["duration_us"],
+               rec["payload"].hex()))
+
+
+def print_stats(records):
+    stats = {}
+    for rec in records:
+        if rec["flags"] & FLAG_ELIDED:
+            continue
+        entry = stats.setdefault(rec["opcode"], {"busy": [], "duration": [], "errors": 0})
+        entry["busy"].append(rec["busy_us"])
+        entry["duration"].append(rec["duration_us"])
+        if rec["flags"] & FLAG_ERROR:
+            entry["errors"] += 1
+
+    elided = sum(1 for rec in records if rec["flags"] & FLAG_ELIDED)
+
+    print()
+    print("%-28s %6s %6s %8s %8s %8s %8s %8s" %
+          ("command", "count", "errors", "busy_avg", "busy_max", "dur_p50", "dur_p99", "dur_max"))
+    for opcode in sorted(stats, key=lambda op: -sum(stats[op]["duration"])):
+        entry = stats[opcode]
+        count = len(entry["duration"])
+        print("%-28s %6d %6d %8d %8d %8d %8d %8d" %
+              (opcode_name(opcode), count, entry["errors"],
+               sum(entry["busy"]) // count, max(entry["busy"]),
+               percentile(entry["duration"], 50), percentile(entry["duration"], 99),
+               max(entry["duration"])))
+    print("skipped (shadowed) commands: %d" % elided)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="console log with SXTR: lines, or binary dump with --binary")
+    parser.add_argument("--binary", action="store_true",
+                        help="input is a raw binary dump of the sx126x_hal_trace symbol")
+    parser.add_argument("--cycles-per-sec", type=int, default=0,
+                        help="cycle counter frequency, overriding the one of the dump")
+    parser.add_argument("--no-timeline", action="store_true", help="only print the statistics")
+    parser.add_argument("--radio-hal", default=RADIO_HAL_SOURCE,
+                        help="sx126x_hal.c with the command list, default %(default)s")
+    args = parser.parse_args()
+
+    OPCODES.update(load_opcodes(args.radio_hal))
+
+    if args.binary:
+        with open(args.input, "rb") as f:
+            data = f.read()
+    else:
+        data = read_console(args.input)
+
+    cycles_per_sec, head, records = parse(data)
+    if args.cycles_per_sec:
+        cycles_per_sec = args.cycles_per_sec
+    if cycles_per_sec == 0:
+        sys.exit("unknown cycle counter frequency, use --cycles-per-sec")
+
+    print("%d records (%d lost), cycle counter %d Hz" %
+          (len(records), head - len(records), cycles_per_sec))
+    if not args.no_timeline:
+        print_timeline(records, cycles_per_sec)
+    if records:
+        print_stats(records)
+
+
+if __name__ == "__main__":
+    main()